@@ -3,6 +3,8 @@
 
 #include "path_point.h"
 
+namespace cones_publisher    // the planner has its own Cone, they can be loaded in one nodelet manager
+{
 
 struct Cone 
 {
@@ -24,7 +26,9 @@ struct Cone
 
 
 
-Cone::Cone(float X, float Y, char col, int ID)
+inline Cone::Cone(float X, float Y, char col, int ID)
 	: position(PathPoint(X, Y)), colour(col), id(ID) {}
 
+} // namespace cones_publisher
+
 #endif // SRC_CONE_H
@@ -7,7 +7,7 @@
 
 #include "cones_publisher.h"
 
-ConesPublisher::ConesPublisher(ros::NodeHandle n) :nh(n)
+ConesPublisher::ConesPublisher(ros::NodeHandle n, bool standalone) :nh(n), standalone(standalone), viz(nh, FRAME)
 {
     //specify minimum size of vectors
     true_cones.reserve(300);
@@ -18,28 +18,25 @@ ConesPublisher::ConesPublisher(ros::NodeHandle n) :nh(n)
     {
         launchSubscribers();
         launchPublishers();
+        publish_timer = nh.createTimer(ros::Duration(1.0/HZ), &ConesPublisher::publishCallback, this);
     }
     
-    waitForMsgs();
     ROS_INFO_STREAM("CONES PUBLISHER: initialized!");
 }
 
-void ConesPublisher::waitForMsgs()
+// called by publish_timer at HZ, msgs are handled by the same spinner (or nodelet manager)
+void ConesPublisher::publishCallback(const ros::TimerEvent&)
 {
-    if (!trueCones_msg_received || !odom_msg_received && ros::ok()) 
-    {
-	ros::spinOnce();
-    }
-}
-
-void ConesPublisher::spin()
-{
-    waitForMsgs();
     detectCones();
     makeUncertain(); //uncomment this to simulate uncertainty
     publishCones();
     clearTemps();
-    ros::Rate(HZ).sleep();
+    if (last_cone)
+    {
+        publish_timer.stop();
+        if (standalone)
+            ros::shutdown();
+    }
 }
 
 void ConesPublisher::clearTemps()
@@ -59,7 +56,8 @@ int ConesPublisher::launchSubscribers()
 int ConesPublisher::launchPublishers()
 {
     pub_cones = nh.advertise<mur_common::cone_msg>(CONE_TOPIC, 1);
-    markers_pub = nh.advertise<visualization_msgs::MarkerArray>(RVIZ_CONES, 1);
+    cone_markers = viz.addMarkerArray(RVIZ_CONES, visualization_msgs::Marker::CUBE_LIST, 0.3, 0.3, 0.7);
+    viz.start();
 }
 
 // get odometry messages
@@ -127,122 +125,65 @@ void ConesPublisher::trueConesCallback(const mur_common::cone_msg &msg)
 void ConesPublisher::publishCones()
 {
     ros::Time current_time = ros::Time::now();
-    visualization_msgs::MarkerArray marker_array_msg;
-    marker_array_msg.markers.resize(seen_cones.size()); ///
-    mur_common::cone_msg cones;
-    cones.header.frame_id = FRAME;
-    cones.header.stamp = current_time;
-    int i = 0;
+    mur_common::cone_msg::Ptr cones = boost::make_shared<mur_common::cone_msg>();
+    cones->header.frame_id = FRAME;
+    cones->header.stamp = current_time;
     if (DEBUG) std::cout<<"seen cones: ";
     for (auto &cn:seen_cones) ////
     {
-        cones.x.push_back(cn.uncertainPos.x);
-        cones.y.push_back(cn.uncertainPos.y);
+        cones->x.push_back(cn.uncertainPos.x);
+        cones->y.push_back(cn.uncertainPos.y);
         if (cn.colour == 'b')
-            cones.colour.push_back("BLUE");
+            cones->colour.push_back("BLUE");
         else if(cn.colour == 'y')
-            cones.colour.push_back("YELLOW");
+            cones->colour.push_back("YELLOW");
         else if(cn.colour == 'r')
-            cones.colour.push_back("ORANGE");
-        
-        // for RVIZ markers
-        setMarkerProperties(&marker_array_msg.markers[i],cn.uncertainPos,i,cones.colour.back(),FRAME);
-        i++;
+            cones->colour.push_back("ORANGE");
+
         if(DEBUG) std::cout<<"("<<cn.position.x<<", "<<cn.position.y<<") ";
     }
     if (DEBUG) std::cout<<"\n"<<std::endl;
     
     pub_cones.publish(cones);
-    markers_pub.publish(marker_array_msg);
+    pushMarkers();
 }
 
-// for RVIZ markers
-// fills in the marker property for each element in Marker array
-void ConesPublisher::setMarkerProperties(visualization_msgs::Marker *marker,PathPoint pos,
-                                            int n,std::string colour,std::string frame_id)
+// for RVIZ markers, one cube per seen cone in the cone colour
+void ConesPublisher::pushMarkers()
 {
-    marker->header.frame_id = frame_id;
-    marker->header.stamp = ros::Time();
-    marker->ns = "my_namespace";
-    marker->id = n;
-    marker->type = visualization_msgs::Marker::CYLINDER;
-    marker->action = visualization_msgs::Marker::ADD;
-
-    marker->pose.position.x = pos.x;
-    marker->pose.position.y = pos.y;
-    marker->pose.position.z = pos.z;
-
-    marker->pose.orientation.x = 0.0;
-    marker->pose.orientation.y = 0.0;
-    marker->pose.orientation.z = 0.0;
-    marker->pose.orientation.w = 1.0;
-
-    marker->scale.x = 0.3;
-    marker->scale.y = 0.3;
-    marker->scale.z = 0.7;
-
-    // alpha and RGB settings
-    marker->color.a = 1;
-
-    if (colour == "BLUE")
-    {
-        marker->color.r = 0.0;
-        marker->color.g = 0.0;
-        marker->color.b = 1.0;
-    }
-    else if (colour == "ORANGE")
+    if (!cone_markers->wanted())
+        return;
+    cone_markers->points.clear();
+    cone_markers->colours.clear();
+    for (auto &cn:seen_cones)
     {
-        marker->color.r = 1.0;
-        marker->color.g = 0.4;
-        marker->color.b = 0.0;
-    }
-    else if (colour == "YELLOW")
-    {
-        marker->color.r = 1.0;
-        marker->color.g = 1.0;
-        marker->color.b = 0.0;
-    }
-    else // UNKNOWN_STR
-    {
-        marker->color.r = 1.0;
-        marker->color.g = 1.0;
-        marker->color.b = 1.0;
+        cone_markers->points.push_back({cn.uncertainPos.x, cn.uncertainPos.y, cn.uncertainPos.z});
+        if (cn.colour == 'b')
+            cone_markers->colours.push_back({0.0, 0.0, 1.0, 1.0});
+        else if (cn.colour == 'y')
+            cone_markers->colours.push_back({1.0, 1.0, 0.0, 1.0});
+        else if (cn.colour == 'r')
+            cone_markers->colours.push_back({1.0, 0.4, 0.0, 1.0});
+        else // unknown
+            cone_markers->colours.push_back({1.0, 1.0, 1.0, 1.0});
     }
-
-    marker->lifetime = ros::Duration(0);
+    cone_markers->commit();
 }
 
-double ConesPublisher::getDistFromCar(PathPoint& pnt) 
-{
-    double dX = car_pose.x - pnt.x;
-	double dY = car_pose.y - pnt.y;
-    return sqrt((dX*dX) + (dY*dY));
-}
-double ConesPublisher::getAngleFromCar(PathPoint& pnt)
+// true if the point is in front of the car (less than 90 degrees either side of the heading)
+bool ConesPublisher::inFrontOfCar(const PathPoint &pnt) const
 {
-    double dX = pnt.x - car_pose.x;
-	double dY = pnt.y - car_pose.y;
-    double ang  = atan2(dY,dX) - car_yaw;
-    if (ang > M_PI)
-        ang -= 2*M_PI;
-    else if (ang < -M_PI)
-        ang += 2*M_PI;
-    
-    return ang*180/M_PI;
+    return geometry::dot<double>(cos(car_yaw), sin(car_yaw), pnt.x - car_pose.x, pnt.y - car_pose.y) > 0;
 }
 
 //to detect cones within sensor range
 void ConesPublisher::detectCones()
 {
-    double dist,angle;
-
     for (int i= 0; i<true_cones.size(); i++)
     {
-        dist = getDistFromCar(true_cones[i].position);
-        if (dist <= SENSOR_RANGE)
+        if (geometry::withinDist(car_pose, true_cones[i].position, SENSOR_RANGE))
         {
-            angle = getAngleFromCar(true_cones[i].position);
-            if (abs(angle)<90)//(0-180)
+            if (inFrontOfCar(true_cones[i].position))
             {
                 bool added = false;
                 for (auto id:cones_list)
@@ -269,7 +210,7 @@ void ConesPublisher::makeUncertain()
     float dist;
     for (auto &con:seen_cones)
     {
-        dist = getDistFromCar(con.position);
+        dist = geometry::dist(car_pose, con.position);
         if (dist>CERTAIN_RANGE)
         {
             if(!con.passedBy)
@@ -286,23 +227,3 @@ void ConesPublisher::makeUncertain()
     }
     
 }
-
-int main(int argc, char **argv)
-{
-    ros::init(argc, argv, "ConesPublisher"); 
-    ros::NodeHandle n;
-       
-    //Initialize Husky Object
-    
-    ConesPublisher conesPub(n);
-        //ros::Rate freq(20);
-	
-	while (ros::ok())
-    {
-	    conesPub.spin();
-        if (conesPub.last_cone)
-            break;
-	}
-    return 0;
-    
-}
@@ -6,8 +6,8 @@
 #include <tf/tf.h>                          // For Convertion from Quartenion to Euler
 #include "mur_common/path_msg.h"            // path msg from mur_common
 #include "mur_common/cone_msg.h"            // cone messages 
-#include <visualization_msgs/Marker.h>      // for RVIZ markers
-#include <visualization_msgs/MarkerArray.h> //fro RVIZ markers
+#include <slowlap_common/viz_publisher.h>   // RVIZ markers, published on their own thread
+#include <slowlap_common/geometry.h>        // distances, in front of the car check
 #include <cmath>
 #include <sstream>
 #include <string>
@@ -17,6 +17,9 @@
 #include "cone.h"
 #include "path_point.h"
 
+using cones_publisher::Cone;
+using cones_publisher::PathPoint;
+
 // ROS topics
 #define ODOM_TOPIC "/mur/slam/Odom"//etry/filtered"                     //"/mur/slam/Odom" in murSim  
 #define TRUE_CONES "/mur/slam/true_cones"
@@ -26,24 +29,27 @@
 
 #define SENSOR_RANGE 16
 #define CERTAIN_RANGE 5.5
-#define HZ 10
+#define HZ 10                   // publish frequency
 
 const bool DEBUG = false;              //to show debug messages in terminal, switch to false to turn off
-bool EUFS = false; //switch to true if using the eufs small track
+const bool EUFS = false; //switch to true if using the eufs small track
 class ConesPublisher
 {
 public:
-    ConesPublisher(ros::NodeHandle);
-    void spin();
+    ConesPublisher(ros::NodeHandle, bool standalone = true);
     bool last_cone = false;
 
 private:
 
+    // msgs are published as shared pointers, nodelets in the same manager get them without serialisation or copies
     ros::NodeHandle nh;
+    ros::Timer publish_timer;           // runs publishCallback at HZ
+    bool standalone;                    // own executable (main.cpp), false when loaded as a nodelet
     ros::Subscriber sub_odom;
     ros::Subscriber sub_cones;
     ros::Publisher pub_cones;
-    ros::Publisher markers_pub;
+    VizPublisher viz;                   // RVIZ, filled only if someone is watching
+    VizLayer *cone_markers;             // all seen cones in one CUBE_LIST
 
     PathPoint car_pose;
     double car_yaw;                      // car yaw in Euler angle
@@ -60,17 +66,15 @@ private:
     
     // *** functions *** //
     //standard ROS functions:
-    void waitForMsgs();
+    void publishCallback(const ros::TimerEvent&);
     void clearTemps();
     int launchSubscribers();
     int launchPublishers();
     void odomCallback(const nav_msgs::Odometry &msg);
     void trueConesCallback(const mur_common::cone_msg &msg);
     void publishCones();
-    void setMarkerProperties(visualization_msgs::Marker *marker,PathPoint pos,
-                            int n,std::string colour,std::string frame_id);
-    double getAngleFromCar(PathPoint& );
-    double getDistFromCar(PathPoint&);
+    void pushMarkers();
+    bool inFrontOfCar(const PathPoint&) const;
     void detectCones();
     void makeUncertain();            
 };
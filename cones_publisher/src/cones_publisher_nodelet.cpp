@@ -0,0 +1,29 @@
+/**
+ * This is the cones publisher as a nodelet
+ * runs ConesPublisher inside a nodelet manager, so cone msgs to the planner nodelet
+ * are passed as pointers instead of being serialised (see slowlap_planner/launch/slow_lap_nodelets.launch)
+**/
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include "cones_publisher.h"
+
+namespace cones_publisher
+{
+
+class ConesPublisherNodelet : public nodelet::Nodelet
+{
+private:
+    std::unique_ptr<ConesPublisher> publisher;
+
+    void onInit() override
+    {
+        // timer and callbacks run on this nodelet's queue
+        publisher.reset(new ConesPublisher(getNodeHandle(), false));
+        NODELET_INFO_STREAM("CONES PUBLISHER: nodelet loaded");
+    }
+};
+
+} // namespace cones_publisher
+
+PLUGINLIB_EXPORT_CLASS(cones_publisher::ConesPublisherNodelet, nodelet::Nodelet)
@@ -0,0 +1,15 @@
+#include <ros/ros.h>
+#include "cones_publisher.h"
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "ConesPublisher"); 
+    ros::NodeHandle n;
+       
+    //Initialize Husky Object
+    
+    ConesPublisher conesPub(n);
+    ros::spin();    // cones are published on a timer (see cones_publisher.cpp)
+    return 0;
+    
+}
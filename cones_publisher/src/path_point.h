@@ -3,6 +3,9 @@
 
 #include "cone.h"
 
+namespace cones_publisher    // the planner has its own PathPoint, they can be loaded in one nodelet manager
+{
+
 struct Cone; //incomplete type for cyclic dependency problem
 
 struct PathPoint
@@ -19,10 +22,10 @@ struct PathPoint
     Cone* cone2 = NULL;
 };
 
-PathPoint::PathPoint() {}
-PathPoint::PathPoint(float X, float Y)
+inline PathPoint::PathPoint() {}
+inline PathPoint::PathPoint(float X, float Y)
 	: x(X), y(Y) {}
 
-
+} // namespace cones_publisher
 
 #endif // SRC_PATH_POINT_H
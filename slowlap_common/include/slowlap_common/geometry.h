@@ -0,0 +1,96 @@
+/**
+ * This is the 2d geometry shared by the slow lap packages (header only, no ROS)
+ * the planner, follower and cones publisher each have their own point type, the functions
+ * take coordinates, or any point with x and y members, and work in float or double
+ * - distance checks compare squared distances (withinDist), no sqrt
+ * - turn checks compare the cosine of the turn with cross/dot products (turnWithin), no atan2,
+ *   the limit is converted once with cosDeg()
+ *
+ * usage:   static const float max_turn = geometry::cosDeg(MAX_PATH_ANGLE1);
+ *          if (geometry::withinDist(p, q, MAX_POINT_DIST) && geometry::turnWithin(dx1, dy1, dx2, dy2, max_turn)) ...
+**/
+
+#ifndef SLOWLAP_COMMON_GEOMETRY_H
+#define SLOWLAP_COMMON_GEOMETRY_H
+
+#include <cmath>
+
+namespace geometry
+{
+
+template <class T>
+constexpr T sq(T v) { return v * v; }
+
+template <class T>
+constexpr T dist2(T x1, T y1, T x2, T y2) { return sq(x2 - x1) + sq(y2 - y1); }
+
+template <class T>
+inline T dist(T x1, T y1, T x2, T y2) { return std::sqrt(dist2(x1, y1, x2, y2)); }
+
+// z of the cross product, > 0 if b is left (counter-clockwise) of a
+template <class T>
+constexpr T cross(T ax, T ay, T bx, T by) { return ax * by - ay * bx; }
+
+template <class T>
+constexpr T dot(T ax, T ay, T bx, T by) { return ax * bx + ay * by; }
+
+// true if (x2, y2) is at most r from (x1, y1)
+template <class T>
+constexpr bool withinDist(T x1, T y1, T x2, T y2, T r) { return dist2(x1, y1, x2, y2) <= r * r; }
+
+// same for points, P and Q are any types with x and y
+template <class P, class Q>
+inline float dist2(const P &p, const Q &q) { return dist2<float>(p.x, p.y, q.x, q.y); }
+
+template <class P, class Q>
+inline float dist(const P &p, const Q &q) { return std::sqrt(dist2(p, q)); }
+
+template <class P, class Q>
+inline bool withinDist(const P &p, const Q &q, float r) { return dist2(p, q) <= r * r; }
+
+// cosine of an angle in degrees, the limit for turnWithin
+inline float cosDeg(float deg) { return std::cos(deg * (float)M_PI / 180); }
+
+// true if the turn from direction a to direction b is at most acos(cos_max) either way
+// (cos of the turn >= cos_max, compared squared so there is no sqrt either)
+template <class T>
+inline bool turnWithin(T ax, T ay, T bx, T by, T cos_max)
+{
+    T d = dot(ax, ay, bx, by);
+    T limit = sq(cos_max) * (sq(ax) + sq(ay)) * (sq(bx) + sq(by));
+    if (cos_max >= 0)
+        return d > 0 && d * d >= limit;
+    return d >= 0 || d * d <= limit;
+}
+
+// signed turn from direction a to direction b, degrees in (-180, 180], left is positive
+template <class T>
+inline T turnAngle(T ax, T ay, T bx, T by)
+{
+    return std::atan2(cross(ax, ay, bx, by), dot(ax, ay, bx, by)) * (T)(180 / M_PI);
+}
+
+// signed curvature (1/radius of the circle through the 3 points), > 0 for a left turn, 0 if 2 points coincide
+template <class T>
+inline T curvature(T x0, T y0, T x1, T y1, T x2, T y2)
+{
+    T d = std::sqrt(dist2(x0, y0, x1, y1) * dist2(x1, y1, x2, y2) * dist2(x0, y0, x2, y2));
+    if (d <= 0)
+        return 0;
+    return 2 * cross(x1 - x0, y1 - y0, x2 - x1, y2 - y1) / d;
+}
+
+// angle in radians to (-pi, pi]
+template <class T>
+inline T wrapAngle(T a)
+{
+    if (a > M_PI)
+        a -= 2 * M_PI;
+    else if (a <= -M_PI)
+        a += 2 * M_PI;
+    return a;
+}
+
+} // namespace geometry
+
+#endif // SLOWLAP_COMMON_GEOMETRY_H
@@ -0,0 +1,90 @@
+/**
+ * This is a fixed memory latency histogram (HDR style, header only)
+ * values are bucketed log-linearly: exact below 2*SUB_BUCKETS, above that each power of 2
+ * is split into SUB_BUCKETS buckets, so every percentile is within ~3% of the true value
+ * recording is a few integer ops, memory (~3.5kB) does not grow with the number of samples
+ *
+ * usage:   hist.record(us);  ...  hist.percentile(0.99), hist.max(), hist.reset()
+**/
+
+#ifndef SLOWLAP_COMMON_LATENCY_HISTOGRAM_H
+#define SLOWLAP_COMMON_LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+class LatencyHistogram
+{
+public:
+    static const int SUB_BITS = 5;
+    static const uint32_t SUB_BUCKETS = 1u << SUB_BITS;             // linear buckets per power of 2
+    static const uint32_t MAX_VALUE = 0xFFFFFFFF;                   // larger values are clamped
+    static const uint32_t BUCKETS = (32 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t value)
+    {
+        uint32_t v = (value > MAX_VALUE) ? MAX_VALUE : (uint32_t)value;
+        counts[bucketIndex(v)]++;
+        total++;
+        if (v > max_value)
+            max_value = v;
+    }
+
+    // smallest value that p (0-1) of the samples are at or below, 0 if empty
+    uint32_t percentile(double p) const
+    {
+        if (total == 0)
+            return 0;
+        uint64_t target = (uint64_t)(p * total + 0.5);
+        if (target < 1)
+            target = 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            seen += counts[i];
+            if (seen >= target)
+                return std::min(bucketTop(i), max_value);
+        }
+        return max_value;
+    }
+
+    uint32_t max() const { return max_value; }
+    uint64_t count() const { return total; }
+
+    void reset()
+    {
+        std::memset(counts, 0, sizeof(counts));
+        total = 0;
+        max_value = 0;
+    }
+
+private:
+    uint32_t counts[BUCKETS];
+    uint64_t total;
+    uint32_t max_value;
+
+    static int msb(uint32_t v) { return 31 - __builtin_clz(v); }
+
+    static uint32_t bucketIndex(uint32_t v)
+    {
+        if (v < 2 * SUB_BUCKETS)
+            return v;
+        int shift = msb(v) - SUB_BITS;
+        return shift * SUB_BUCKETS + (v >> shift);
+    }
+
+    // largest value that falls into bucket i
+    static uint32_t bucketTop(uint32_t i)
+    {
+        if (i < 2 * SUB_BUCKETS)
+            return i;
+        int shift = i / SUB_BUCKETS - 1;
+        uint64_t top = ((uint64_t)(i - shift * SUB_BUCKETS + 1) << shift) - 1;
+        return (top > MAX_VALUE) ? MAX_VALUE : (uint32_t)top;
+    }
+};
+
+#endif // SLOWLAP_COMMON_LATENCY_HISTOGRAM_H
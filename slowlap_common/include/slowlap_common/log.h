@@ -0,0 +1,298 @@
+/**
+ * This is the asynchronous logger shared by the slow lap packages (header only)
+ * a log call only copies a binary record (time, level, format string pointer, arguments)
+ * into a lock-free ring buffer owned by the calling thread, formatting and terminal I/O
+ * are done later by a background thread, so the control loops never wait on std::cout
+ *
+ * usage:   LOG_DEBUG("[PLANNER] sent path points: {}", centre_points.size());
+ * - the format string must be a string literal, {} is replaced by the next argument
+ * - up to LOG_MAX_ARGS numbers, chars, bools or short strings (copied, max LOG_STR_LEN-1 chars)
+ * - levels below SLOWLAP_LOG_LEVEL are compiled out (e.g. add_definitions(-DSLOWLAP_LOG_LEVEL=1)),
+ *   slowlap_log::setLevel() raises the level at runtime
+ * - if a ring is full the record is dropped and counted, a log call never blocks
+**/
+
+#ifndef SLOWLAP_COMMON_LOG_H
+#define SLOWLAP_COMMON_LOG_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+#ifndef SLOWLAP_LOG_LEVEL
+#define SLOWLAP_LOG_LEVEL LOG_LEVEL_DEBUG   // everything is logged unless set by the build
+#endif
+
+#define LOG_MAX_ARGS 6          // max arguments per record
+#define LOG_STR_LEN 16          // max string argument length (incl. terminating null)
+#define LOG_RING_SIZE 1024      // records per thread, must be a power of 2
+#define LOG_IDLE_MS 5           // background thread sleep when there is nothing to print
+
+namespace slowlap_log
+{
+
+// one argument of a record
+struct Arg
+{
+    enum Type : uint8_t { INT, UINT, DOUBLE, CHAR, STR };
+    Type type;
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double d;
+        char c;
+        char s[LOG_STR_LEN];
+    };
+};
+
+// one log call
+struct Record
+{
+    uint64_t time_ns;           // steady clock
+    const char *fmt;            // string literal, never copied
+    uint8_t level;
+    uint8_t n_args;
+    Arg args[LOG_MAX_ARGS];
+};
+
+inline void setArg(Arg &a, double v) { a.type = Arg::DOUBLE; a.d = v; }
+inline void setArg(Arg &a, float v) { a.type = Arg::DOUBLE; a.d = v; }
+inline void setArg(Arg &a, int v) { a.type = Arg::INT; a.i = v; }
+inline void setArg(Arg &a, long v) { a.type = Arg::INT; a.i = v; }
+inline void setArg(Arg &a, long long v) { a.type = Arg::INT; a.i = v; }
+inline void setArg(Arg &a, unsigned int v) { a.type = Arg::UINT; a.u = v; }
+inline void setArg(Arg &a, unsigned long v) { a.type = Arg::UINT; a.u = v; }
+inline void setArg(Arg &a, unsigned long long v) { a.type = Arg::UINT; a.u = v; }
+inline void setArg(Arg &a, bool v) { a.type = Arg::INT; a.i = v; }
+inline void setArg(Arg &a, char v) { a.type = Arg::CHAR; a.c = v; }
+inline void setArg(Arg &a, const char *v)
+{
+    a.type = Arg::STR;
+    std::strncpy(a.s, v, LOG_STR_LEN - 1);
+    a.s[LOG_STR_LEN - 1] = '\0';
+}
+inline void setArg(Arg &a, const std::string &v) { setArg(a, v.c_str()); }
+
+inline void setArgs(Record&, int) {}
+
+template <typename T, typename... Rest>
+inline void setArgs(Record &r, int i, const T &first, const Rest&... rest)
+{
+    setArg(r.args[i], first);
+    setArgs(r, i + 1, rest...);
+}
+
+// single producer (the owning thread), single consumer (the logger thread) ring of records
+class Ring
+{
+public:
+    // reserve the next free slot, NULL if the ring is full
+    Record* claim()
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        return &records[h & (LOG_RING_SIZE - 1)];
+    }
+    void publish() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // consumer side
+    const Record* front()
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return NULL;
+        return &records[t & (LOG_RING_SIZE - 1)];
+    }
+    void pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    std::atomic<uint32_t> dropped{0};   // records lost because the ring was full
+
+private:
+    Record records[LOG_RING_SIZE];
+    std::atomic<uint32_t> head{0};      // written by producer
+    std::atomic<uint32_t> tail{0};      // written by consumer
+};
+
+// owns the rings of all threads and the background thread that prints them
+class Logger
+{
+public:
+    static Logger& instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    // ring of the calling thread, created on its first log call
+    Ring& ring()
+    {
+        thread_local Ring *r = NULL;
+        if (r == NULL)
+            r = addRing();
+        return *r;
+    }
+
+    std::atomic<int> level{SLOWLAP_LOG_LEVEL};
+
+    ~Logger()
+    {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+        drain(); //print what is left
+    }
+
+private:
+    std::mutex rings_mutex;                     // only taken when a thread logs for the first time
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<bool> running{false};
+    std::thread worker;
+    uint64_t start_ns = now();
+
+    Ring* addRing()
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.emplace_back(new Ring());
+        if (!running.exchange(true))
+            worker = std::thread(&Logger::run, this);
+        return rings.back().get();
+    }
+
+    void run()
+    {
+        while (running.load())
+        {
+            if (!drain())
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_MS));
+        }
+    }
+
+    // print all pending records, returns false if there were none
+    bool drain()
+    {
+        std::vector<Ring*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            for (auto &r: rings)
+                snapshot.push_back(r.get());
+        }
+        bool printed = false;
+        for (auto r: snapshot)
+        {
+            uint32_t lost = r->dropped.exchange(0, std::memory_order_relaxed);
+            if (lost > 0)
+                std::fprintf(stderr, "[LOG] %u records dropped (ring full)\n", lost);
+            const Record *rec;
+            while ((rec = r->front()) != NULL)
+            {
+                print(*rec);
+                r->pop();
+                printed = true;
+            }
+        }
+        if (printed)
+            std::fflush(stdout);
+        return printed;
+    }
+
+    void print(const Record &rec)
+    {
+        static const char *names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+        FILE *out = (rec.level >= LOG_LEVEL_WARN) ? stderr : stdout;
+        std::fprintf(out, "[%10.6f] [%s] ", (rec.time_ns - start_ns) * 1e-9, names[rec.level]);
+        int arg = 0;
+        for (const char *p = rec.fmt; *p != '\0'; p++)
+        {
+            if (p[0] == '{' && p[1] == '}' && arg < rec.n_args)
+            {
+                const Arg &a = rec.args[arg++];
+                switch (a.type)
+                {
+                    case Arg::INT: std::fprintf(out, "%lld", (long long)a.i); break;
+                    case Arg::UINT: std::fprintf(out, "%llu", (unsigned long long)a.u); break;
+                    case Arg::DOUBLE: std::fprintf(out, "%g", a.d); break;
+                    case Arg::CHAR: std::fputc(a.c, out); break;
+                    case Arg::STR: std::fputs(a.s, out); break;
+                }
+                p++;
+            }
+            else
+                std::fputc(*p, out);
+        }
+        std::fputc('\n', out);
+    }
+
+public:
+    static uint64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+inline void setLevel(int level) { Logger::instance().level.store(level, std::memory_order_relaxed); }
+
+template <typename... Args>
+inline void log(int level, const char *fmt, const Args&... args)
+{
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments, see LOG_MAX_ARGS");
+    Logger &logger = Logger::instance();
+    if (level < logger.level.load(std::memory_order_relaxed))
+        return;
+    Ring &ring = logger.ring();
+    Record *r = ring.claim();
+    if (r == NULL)
+        return;
+    r->time_ns = Logger::now();
+    r->fmt = fmt;
+    r->level = level;
+    r->n_args = sizeof...(Args);
+    setArgs(*r, 0, args...);
+    ring.publish();
+}
+
+} // namespace slowlap_log
+
+#if SLOWLAP_LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) slowlap_log::log(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#if SLOWLAP_LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) slowlap_log::log(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if SLOWLAP_LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) slowlap_log::log(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if SLOWLAP_LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) slowlap_log::log(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#endif // SLOWLAP_COMMON_LOG_H
@@ -0,0 +1,139 @@
+/**
+ * This is the path stream between the planner and the follower (header only, no ROS)
+ * the planner's path only grows at the end, or loses its last points when they are re-planned,
+ * so instead of the whole path each msg carries:
+ * - seq, +1 every msg
+ * - retract_from, the path points from this index on are removed
+ * - the points appended after that
+ * every PATH_KEYFRAME_INTERVAL updates the whole path is sent (keyframe), so a follower that
+ * started late or lost a msg is back in sync after at most one keyframe interval
+ *
+ * Delta is any type with seq, keyframe, retract_from and x/y/v vectors (slowlap_common::path_delta_msg, PathDelta)
+ * usage:   planner:  if (writer.update(path, msg)) publish(msg);
+ *          follower: if (reader.accept(msg, points.size())) { keep = reader.keep(msg, points); cut points to keep;
+ *                    append msg.x/y from firstNew(msg, keep) }
+**/
+
+#ifndef SLOWLAP_COMMON_PATH_STREAM_H
+#define SLOWLAP_COMMON_PATH_STREAM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define PATH_KEYFRAME_INTERVAL 20      // updates between keyframes (~2s at the SLAM rate)
+
+// plain (non ROS) stream msg, e.g. for the offline replay
+struct PathDelta
+{
+    uint32_t seq = 0;
+    bool keyframe = false;
+    uint32_t retract_from = 0;
+    std::vector<float> x, y, v;
+};
+
+// planner side, remembers what has been sent
+class PathStreamWriter
+{
+public:
+    explicit PathStreamWriter(uint32_t keyframe_interval = PATH_KEYFRAME_INTERVAL)
+        : keyframe_interval(keyframe_interval) {}
+
+    // fills delta with the changes of path (points with x, y and velocity) since the last msg
+    // returns false if there is nothing to send (no change and no keyframe due)
+    template <class Points, class Delta>
+    bool update(const Points &path, Delta &delta)
+    {
+        size_t n = path.size();
+        size_t same = 0;    // leading points that are unchanged
+        while (same < n && same < sent_x.size() && path[same].x == sent_x[same] &&
+               path[same].y == sent_y[same] && path[same].velocity == sent_v[same])
+            same++;
+        bool changed = (same < n) || (same < sent_x.size());
+
+        since_keyframe++;
+        bool keyframe = (seq == 0) || (since_keyframe >= keyframe_interval);
+        if (!changed && !keyframe)
+            return false;
+        if (keyframe)
+            since_keyframe = 0;
+
+        sent_x.resize(same);
+        sent_y.resize(same);
+        sent_v.resize(same);
+        size_t from = keyframe ? 0 : same;
+        delta.seq = seq++;
+        delta.keyframe = keyframe;
+        delta.retract_from = from;
+        delta.x.clear();
+        delta.y.clear();
+        delta.v.clear();
+        for (size_t i = from; i < n; i++)
+        {
+            delta.x.push_back(path[i].x);
+            delta.y.push_back(path[i].y);
+            delta.v.push_back(path[i].velocity);
+        }
+        for (size_t i = same; i < n; i++)
+        {
+            sent_x.push_back(path[i].x);
+            sent_y.push_back(path[i].y);
+            sent_v.push_back(path[i].velocity);
+        }
+        return true;
+    }
+
+private:
+    uint32_t keyframe_interval;
+    uint32_t seq = 0;                       // of the next msg
+    uint32_t since_keyframe = 0;            // updates since the last keyframe
+    std::vector<float> sent_x, sent_y, sent_v;  // path as the follower has it
+};
+
+// follower side, keeps track of the sequence
+class PathStreamReader
+{
+public:
+    // checks a msg against the stream, returns false if it has to be dropped:
+    // no keyframe received yet, a msg was lost, or it does not fit the path the follower has
+    template <class Delta>
+    bool accept(const Delta &delta, size_t path_size)
+    {
+        if (delta.keyframe)
+            synced = true;
+        else if (!synced || delta.seq != last_seq + 1 || delta.retract_from > path_size)
+        {
+            synced = false; // wait for the next keyframe
+            return false;
+        }
+        last_seq = delta.seq;
+        return true;
+    }
+
+    // number of points of the current path that the msg keeps
+    // for keyframes the points equal to the current ones (position and velocity) are kept, so nothing is rebuilt needlessly
+    template <class Delta, class Points>
+    static size_t keep(const Delta &delta, const Points &path)
+    {
+        if (!delta.keyframe)
+            return delta.retract_from;
+        size_t same = 0;
+        while (same < path.size() && same < delta.x.size() && path[same].x == delta.x[same] && path[same].y == delta.y[same] &&
+               path[same].velocity == delta.v[same])
+            same++;
+        return same;
+    }
+
+    // index of the first msg point that is not in the path yet, after cutting it to keep points
+    template <class Delta>
+    static size_t firstNew(const Delta &delta, size_t keep)
+    {
+        return delta.keyframe ? keep : 0;
+    }
+
+private:
+    bool synced = false;
+    uint32_t last_seq = 0;
+};
+
+#endif // SLOWLAP_COMMON_PATH_STREAM_H
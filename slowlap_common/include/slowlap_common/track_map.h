@@ -0,0 +1,255 @@
+/**
+ * This is the binary track map file (header only, no ROS, POSIX mmap)
+ * written once by the planner when the slow lap is complete, read by the fast lap or a restarted planner
+ * the file is mapped into memory and used in place, there is nothing to parse:
+ * - TrackMapHeader (64 bytes): magic, version, counts, CRC-32 of the header and of the payload
+ * - payload: float arrays, one after the other
+ *   left x, left y, right x, right y (sorted cones, track order)
+ *   centre x, centre y, arc length s, heading (rad), curvature (1/m, > 0 turning left)
+ * all values are little endian (the car and the laptops are x86)
+ *
+ * usage:   writeTrackMap(file, data);
+ *          TrackMapView map;
+ *          if (map.open(file)) { const float *s = map.centreS(); ... } else std::cerr << map.error();
+**/
+
+#ifndef SLOWLAP_COMMON_TRACK_MAP_H
+#define SLOWLAP_COMMON_TRACK_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "geometry.h"
+
+#define TRACK_MAP_VERSION 1         // bump when the layout changes, older files are then rejected
+#define TRACK_MAP_MAGIC "SLTRKMAP"  // 8 chars, no terminating 0 in the file
+#define TRACK_MAP_CLOSED_DIST 0.1   // the centre line is a loop if its ends are closer than this (m)
+
+struct TrackMapHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;           // sizeof(TrackMapHeader)
+    uint32_t left_count;
+    uint32_t right_count;
+    uint32_t centre_count;
+    uint32_t closed;                // 1 if the centre line is a loop (last point on the first)
+    uint64_t payload_size;          // bytes after the header
+    uint32_t payload_crc;           // CRC-32 of the payload
+    uint32_t header_crc;            // CRC-32 of the header bytes before this field
+    uint8_t reserved[16];
+};
+static_assert(sizeof(TrackMapHeader) == 64, "track map header must stay 64 bytes");
+
+// what the planner has at the end of the slow lap
+struct TrackMapData
+{
+    std::vector<float> left_x, left_y;
+    std::vector<float> right_x, right_y;
+    std::vector<float> centre_x, centre_y;
+};
+
+// CRC-32 (IEEE), crc is the value of the bytes before, for checksums over several blocks
+inline uint32_t trackMapCrc(const void *data, size_t size, uint32_t crc = 0)
+{
+    struct Table
+    {
+        uint32_t v[256];
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    };
+    static const Table table;
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// writes the map to file, with arc length, heading and curvature of the centre line worked out here
+// the file is written to file.tmp and then renamed, so a reader never maps a half written map
+// false (nothing written) if the centre line or a side of cones is empty, or the coordinate arrays differ in length
+inline bool writeTrackMap(const std::string &file, const TrackMapData &data)
+{
+    size_t n = data.centre_x.size();
+    if (n == 0 || data.left_x.empty() || data.right_x.empty() || data.left_y.size() != data.left_x.size() || data.right_y.size() != data.right_x.size() || data.centre_y.size() != n)
+        return false;
+    bool closed = n > 2 && geometry::withinDist<float>(data.centre_x[0], data.centre_y[0],
+                                                      data.centre_x[n-1], data.centre_y[n-1], TRACK_MAP_CLOSED_DIST);
+
+    std::vector<float> s(n, 0), heading(n, 0), curvature(n, 0);
+    for (size_t i = 1; i < n; i++)
+        s[i] = s[i-1] + geometry::dist<float>(data.centre_x[i-1], data.centre_y[i-1], data.centre_x[i], data.centre_y[i]);
+    for (size_t i = 0; i < n && n > 1; i++)
+    {
+        // neighbours, around the loop if the centre line is closed (its last point is the first one again)
+        size_t prev = (i > 0) ? i - 1 : (closed ? n - 2 : 0);
+        size_t next = (i + 1 < n) ? i + 1 : (closed ? 1 : n - 1);
+        heading[i] = std::atan2(data.centre_y[next] - data.centre_y[prev], data.centre_x[next] - data.centre_x[prev]);
+        if (prev != i && next != i)
+            curvature[i] = geometry::curvature(data.centre_x[prev], data.centre_y[prev], data.centre_x[i], data.centre_y[i],
+                                               data.centre_x[next], data.centre_y[next]);
+    }
+
+    const std::vector<float> *arrays[9] = {&data.left_x, &data.left_y, &data.right_x, &data.right_y,
+                                           &data.centre_x, &data.centre_y, &s, &heading, &curvature};
+    TrackMapHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TRACK_MAP_MAGIC, sizeof(header.magic));
+    header.version = TRACK_MAP_VERSION;
+    header.header_size = sizeof(TrackMapHeader);
+    header.left_count = data.left_x.size();
+    header.right_count = data.right_x.size();
+    header.centre_count = n;
+    header.closed = closed;
+    uint32_t crc = 0;
+    for (auto a: arrays)
+    {
+        header.payload_size += a->size() * sizeof(float);
+        crc = trackMapCrc(a->data(), a->size() * sizeof(float), crc);
+    }
+    header.payload_crc = crc;
+    header.header_crc = trackMapCrc(&header, offsetof(TrackMapHeader, header_crc));
+
+    std::string tmp = file + ".tmp";
+    FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (f == NULL)
+        return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    for (auto a: arrays)
+        ok = ok && (a->empty() || std::fwrite(a->data(), sizeof(float), a->size(), f) == a->size());
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok)
+        ok = std::rename(tmp.c_str(), file.c_str()) == 0;
+    if (!ok)
+        std::remove(tmp.c_str());
+    return ok;
+}
+
+// read only view of a map file, the arrays point straight into the mapped file
+class TrackMapView
+{
+public:
+    TrackMapView() {}
+    TrackMapView(const TrackMapView&) = delete;
+    TrackMapView& operator=(const TrackMapView&) = delete;
+    ~TrackMapView() { close(); }
+
+    // maps the file and checks it, false if it is missing, from another version or corrupt (see error())
+    bool open(const std::string &file)
+    {
+        close();
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            return fail("cannot open file");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TrackMapHeader))
+        {
+            ::close(fd);
+            return fail("file too short");
+        }
+        size = st.st_size;
+        void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);    // the mapping stays
+        if (p == MAP_FAILED)
+            return fail("mmap failed");
+        base = static_cast<const uint8_t*>(p);
+        return check();
+    }
+
+    void close()
+    {
+        if (base != NULL)
+            munmap(const_cast<uint8_t*>(base), size);
+        base = NULL;
+        header = NULL;
+        size = 0;
+    }
+
+    bool valid() const { return header != NULL; }
+    const char* error() const { return err; }
+
+    uint32_t leftCount() const { return header->left_count; }
+    uint32_t rightCount() const { return header->right_count; }
+    uint32_t centreCount() const { return header->centre_count; }
+    bool closed() const { return header->closed != 0; }
+
+    const float* leftX() const { return section[0]; }
+    const float* leftY() const { return section[1]; }
+    const float* rightX() const { return section[2]; }
+    const float* rightY() const { return section[3]; }
+    const float* centreX() const { return section[4]; }
+    const float* centreY() const { return section[5]; }
+    const float* centreS() const { return section[6]; }            // arc length from the first point (m)
+    const float* centreHeading() const { return section[7]; }      // rad
+    const float* centreCurvature() const { return section[8]; }    // 1/m
+
+private:
+    const uint8_t *base = NULL;
+    size_t size = 0;
+    const TrackMapHeader *header = NULL;    // NULL unless the map is valid
+    const float *section[9] = {};
+    const char *err = "not opened";
+
+    bool fail(const char *why)
+    {
+        close();
+        err = why;
+        return false;
+    }
+
+    bool check()
+    {
+        const TrackMapHeader *h = reinterpret_cast<const TrackMapHeader*>(base);
+        if (std::memcmp(h->magic, TRACK_MAP_MAGIC, sizeof(h->magic)) != 0)
+            return fail("not a track map");
+        if (h->version != TRACK_MAP_VERSION || h->header_size != sizeof(TrackMapHeader))
+            return fail("track map version not supported");
+        if (h->header_crc != trackMapCrc(h, offsetof(TrackMapHeader, header_crc)))
+            return fail("header checksum mismatch");
+        if (h->centre_count == 0)
+            return fail("empty centre line");
+        if (h->left_count == 0 || h->right_count == 0)
+            return fail("no cones on one side");
+
+        // floats in each payload array, in file order
+        uint32_t counts[9] = {h->left_count, h->left_count, h->right_count, h->right_count,
+                              h->centre_count, h->centre_count, h->centre_count, h->centre_count, h->centre_count};
+        uint64_t payload = 0;
+        for (int i = 0; i < 9; i++)
+            payload += (uint64_t)counts[i] * sizeof(float);
+        if (payload != h->payload_size || size != sizeof(TrackMapHeader) + payload)
+            return fail("size does not match the header");
+        if (h->payload_crc != trackMapCrc(base + sizeof(TrackMapHeader), payload))
+            return fail("payload checksum mismatch");
+
+        // the header is 64 bytes and every array holds floats, so every section is 4 byte aligned
+        const float *p = reinterpret_cast<const float*>(base + sizeof(TrackMapHeader));
+        for (int i = 0; i < 9; i++)
+        {
+            section[i] = p;
+            p += counts[i];
+        }
+        header = h;
+        err = "";
+        return true;
+    }
+};
+
+#endif // SLOWLAP_COMMON_TRACK_MAP_H
@@ -0,0 +1,53 @@
+/**
+ * This is a lock-free triple buffer for handing the latest value from one thread to another (header only)
+ * the producer fills back() and publish()es it, the consumer calls update() and reads front()
+ * publish/update only swap slot indices, nothing is copied, neither side ever waits
+ * if the producer is faster, values the consumer did not pick up are overwritten (latest value wins)
+ *
+ * usage:   producer: fill(buf.back()); buf.publish();      consumer: if (buf.update()) use(buf.front());
+**/
+
+#ifndef SLOWLAP_COMMON_TRIPLE_BUFFER_H
+#define SLOWLAP_COMMON_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer
+{
+public:
+    // producer side
+    T& back() { return slots[back_index]; }
+    void publish()
+    {
+        uint8_t old = middle.exchange(back_index | FRESH, std::memory_order_acq_rel);
+        back_index = old & INDEX;
+    }
+
+    // consumer side, update() returns false if nothing was published since the last call
+    bool fresh() const { return middle.load(std::memory_order_acquire) & FRESH; }
+    bool update()
+    {
+        if (!fresh())
+            return false;
+        uint8_t old = middle.exchange(front_index, std::memory_order_acq_rel);
+        front_index = old & INDEX;
+        return true;
+    }
+    T& front() { return slots[front_index]; }
+
+    // setup before the threads start (e.g. reserving memory in every slot)
+    T& slot(int i) { return slots[i]; }
+
+private:
+    static const uint8_t INDEX = 0x3;
+    static const uint8_t FRESH = 0x4;       // middle slot holds a value the consumer has not taken yet
+
+    T slots[3];
+    alignas(64) uint8_t back_index = 0;             // producer only
+    alignas(64) std::atomic<uint8_t> middle{1};     // shared
+    alignas(64) uint8_t front_index = 2;            // consumer only
+};
+
+#endif // SLOWLAP_COMMON_TRIPLE_BUFFER_H
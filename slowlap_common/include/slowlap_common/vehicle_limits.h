@@ -0,0 +1,17 @@
+/**
+ * This is the longitudinal limits of the car, shared by the planner (velocity profile) and the follower (acceleration command)
+ * and the defaults of the speed params, read by both (the follower's closed lap uses the same limits as the planner's profile)
+**/
+
+#ifndef SLOWLAP_COMMON_VEHICLE_LIMITS_H
+#define SLOWLAP_COMMON_VEHICLE_LIMITS_H
+
+#define MAX_ACC 11.772              // 1.2*G, copied from Dennis (MURauto20)
+#define MAX_DECEL -17.658           // -1.8*Gg copied from Dennis (MURauto20)
+
+// defaults of the ROS params v_max, v_const and max_f_gain (constant_v defaults to false)
+#define DEFAULT_V_MAX 5.0           // velocity limit on straights (m/s)
+#define DEFAULT_V_CONST 3.0         // velocity of every path point with constant_v (m/s)
+#define DEFAULT_MAX_F_GAIN 3.0      // lateral acceleration limit (m/s^2), v = sqrt(max_f_gain * radius)
+
+#endif // SLOWLAP_COMMON_VEHICLE_LIMITS_H
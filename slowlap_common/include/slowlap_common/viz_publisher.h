@@ -0,0 +1,266 @@
+/**
+ * This is the rviz publisher shared by the slow lap nodes (header only, needs roscpp)
+ * rviz msgs are built and published on a background thread at VIZ_HZ, not in the control/planning loop
+ * - every topic is a layer with one batched marker (LINE_LIST, CUBE_LIST, ...) or a nav_msgs::Path
+ * - the node only fills a layer if someone subscribes to it (wanted())
+ * - commit() copies the points only if they changed, unchanged layers are not sent again
+ * - publishers are latched, rviz gets the last msg when it connects
+ *
+ * usage:   VizLayer *cones = viz.addMarkerArray(topic, visualization_msgs::Marker::CUBE_LIST, 0.3, 0.3, 0.7);
+ *          viz.start();
+ *          if (cones->wanted()) { cones->points = ...; cones->colours = ...; cones->commit(); }
+**/
+
+#ifndef SLOWLAP_COMMON_VIZ_PUBLISHER_H
+#define SLOWLAP_COMMON_VIZ_PUBLISHER_H
+
+#include <ros/ros.h>
+#include <nav_msgs/Path.h>
+#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#define VIZ_HZ 4        // rviz publish rate, well below the control/SLAM rate
+
+struct VizPoint
+{
+    float x, y, z;
+    bool operator==(const VizPoint &o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct VizColour
+{
+    float r, g, b, a;
+    bool operator==(const VizColour &o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+};
+
+// one rviz topic
+class VizLayer
+{
+public:
+    enum Output { PATH, MARKER, MARKER_ARRAY };
+
+    // filled by the node, then commit()ed. colours: one per point, or a single one for all points
+    std::vector<VizPoint> points;
+    std::vector<VizColour> colours;
+
+    // false if nobody subscribes, then filling the layer can be skipped
+    bool wanted() const { return pub.getNumSubscribers() > 0; }
+
+    // hands points/colours to the publishing thread, does nothing if they did not change
+    void commit()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (points == committed_points && colours == committed_colours)
+            return;
+        committed_points = points;
+        committed_colours = colours;
+        dirty = true;
+    }
+
+private:
+    friend class VizPublisher;
+
+    ros::Publisher pub;
+    Output output;
+    int marker_type;                            // visualization_msgs::Marker type, not used for paths
+    float scale[3];
+
+    std::mutex mutex;                           // guards the committed points and dirty
+    std::vector<VizPoint> committed_points;
+    std::vector<VizColour> committed_colours;
+    bool dirty = false;                         // committed but not published yet
+
+    // publishing thread only
+    std::vector<VizPoint> send_points;
+    std::vector<VizColour> send_colours;
+};
+
+class VizPublisher
+{
+public:
+    VizPublisher(ros::NodeHandle &nh, const std::string &frame, double hz = VIZ_HZ)
+        : nh(nh), frame(frame), hz(hz) {}
+
+    ~VizPublisher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            running = false;
+        }
+        wake.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    // layers are added before start(), the returned pointers stay valid as long as the VizPublisher
+    VizLayer* addPath(const std::string &topic)
+    {
+        VizLayer *layer = add(VizLayer::PATH, 0, 0, 0, 0);
+        layer->pub = nh.advertise<nav_msgs::Path>(topic, 1, true);
+        return layer;
+    }
+
+    VizLayer* addMarker(const std::string &topic, int marker_type, float sx, float sy, float sz)
+    {
+        VizLayer *layer = add(VizLayer::MARKER, marker_type, sx, sy, sz);
+        layer->pub = nh.advertise<visualization_msgs::Marker>(topic, 1, true);
+        return layer;
+    }
+
+    // same as addMarker, for topics that rviz configs already show as a MarkerArray (holds the one marker)
+    VizLayer* addMarkerArray(const std::string &topic, int marker_type, float sx, float sy, float sz)
+    {
+        VizLayer *layer = add(VizLayer::MARKER_ARRAY, marker_type, sx, sy, sz);
+        layer->pub = nh.advertise<visualization_msgs::MarkerArray>(topic, 1, true);
+        return layer;
+    }
+
+    void start()
+    {
+        running = true;
+        thread = std::thread(&VizPublisher::loop, this);
+    }
+
+    // publishes everything committed, on the calling thread (e.g. the last msgs before shutting down)
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(publish_mutex);
+        publishDirty();
+    }
+
+private:
+    ros::NodeHandle nh;
+    std::string frame;
+    double hz;
+    std::vector<std::unique_ptr<VizLayer>> layers;
+
+    std::thread thread;
+    bool running = false;                       // guarded by wake_mutex
+    std::mutex wake_mutex;                      // only used to sleep/wake the thread
+    std::condition_variable wake;
+    std::mutex publish_mutex;                   // publishing thread vs flush()
+
+    VizLayer* add(VizLayer::Output output, int marker_type, float sx, float sy, float sz)
+    {
+        layers.emplace_back(new VizLayer());
+        VizLayer *layer = layers.back().get();
+        layer->output = output;
+        layer->marker_type = marker_type;
+        layer->scale[0] = sx;
+        layer->scale[1] = sy;
+        layer->scale[2] = sz;
+        return layer;
+    }
+
+    void loop()
+    {
+        auto period = std::chrono::duration<double>(1.0 / hz);
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (!wake.wait_for(lock, period, [this] { return !running; }))
+        {
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    // layers nobody listens to stay dirty, so a late subscriber gets the latest points
+    void publishDirty()
+    {
+        for (auto &layer: layers)
+        {
+            if (!layer->wanted())
+                continue;
+            {
+                std::lock_guard<std::mutex> lock(layer->mutex);
+                if (!layer->dirty)
+                    continue;
+                layer->send_points = layer->committed_points;
+                layer->send_colours = layer->committed_colours;
+                layer->dirty = false;
+            }
+            if (layer->output == VizLayer::PATH)
+                publishPath(*layer);
+            else
+                publishMarker(*layer);
+        }
+    }
+
+    void publishPath(const VizLayer &layer)
+    {
+        nav_msgs::Path::Ptr msg = boost::make_shared<nav_msgs::Path>();
+        msg->header.frame_id = frame;
+        msg->header.stamp = ros::Time::now();
+        msg->poses.resize(layer.send_points.size());
+        for (size_t i = 0; i < layer.send_points.size(); i++)
+        {
+            geometry_msgs::PoseStamped &pose = msg->poses[i];
+            pose.header.frame_id = frame;
+            pose.header.seq = i;
+            pose.pose.position.x = layer.send_points[i].x;
+            pose.pose.position.y = layer.send_points[i].y;
+            pose.pose.position.z = layer.send_points[i].z;
+        }
+        layer.pub.publish(msg);
+    }
+
+    void publishMarker(const VizLayer &layer)
+    {
+        visualization_msgs::Marker::Ptr marker = boost::make_shared<visualization_msgs::Marker>();
+        marker->header.frame_id = frame;
+        marker->header.stamp = ros::Time::now();
+        marker->ns = "slowlap";
+        marker->id = 0;
+        marker->type = layer.marker_type;
+        marker->action = layer.send_points.empty() ? visualization_msgs::Marker::DELETE
+                                                   : visualization_msgs::Marker::ADD;
+        marker->pose.orientation.w = 1.0;
+        marker->scale.x = layer.scale[0];
+        marker->scale.y = layer.scale[1];
+        marker->scale.z = layer.scale[2];
+
+        marker->points.resize(layer.send_points.size());
+        for (size_t i = 0; i < layer.send_points.size(); i++)
+        {
+            marker->points[i].x = layer.send_points[i].x;
+            marker->points[i].y = layer.send_points[i].y;
+            marker->points[i].z = layer.send_points[i].z;
+        }
+        if (layer.send_colours.size() == 1)
+            setColour(marker->color, layer.send_colours[0]);
+        else
+        {
+            marker->color.a = 1.0;
+            marker->colors.resize(layer.send_colours.size());
+            for (size_t i = 0; i < layer.send_colours.size(); i++)
+                setColour(marker->colors[i], layer.send_colours[i]);
+        }
+
+        if (layer.output == VizLayer::MARKER)
+            layer.pub.publish(marker);
+        else
+        {
+            visualization_msgs::MarkerArray::Ptr array = boost::make_shared<visualization_msgs::MarkerArray>();
+            array->markers.push_back(*marker);
+            layer.pub.publish(array);
+        }
+    }
+
+    static void setColour(std_msgs::ColorRGBA &out, const VizColour &c)
+    {
+        out.r = c.r;
+        out.g = c.g;
+        out.b = c.b;
+        out.a = c.a;
+    }
+};
+
+#endif // SLOWLAP_COMMON_VIZ_PUBLISHER_H
@@ -0,0 +1,295 @@
+/**
+ * This is the ROS-free part of the path follower, see follower_core.h
+ * path points are splined, then the goal point is searched on the splined path (pure pursuit)
+ * follower.cpp only handles the ROS msgs
+*/
+
+#include "follower_core.h"
+
+// constructor
+FollowerCore::FollowerCore()
+{
+    //set capacity of vectors
+    centre_points.reserve(500);
+    segments.reserve(500);
+}
+
+FollowerCore::~FollowerCore()
+{
+    if (lap_thread.joinable())
+        lap_thread.join();
+}
+
+// clear temporary flags
+void FollowerCore::clearVars()
+{
+    new_centre_points = false;
+    cenPoints_updated = 0;
+    newGP = false;
+}
+
+// new car pose (from odometry)
+void FollowerCore::updatePose(double x, double y, double yaw, double v)
+{
+    if (!initialised)
+    {
+       initX = x;
+       initY = y;
+       initYaw = car_yaw;
+       initialised = true;
+       currentGoalPoint.updatePoint(Waypoint(initX,initY));
+       LOG_DEBUG("[FOLLOWER] initial goal point is: ({}, {}) ", currentGoalPoint.x, currentGoalPoint.y);
+    }
+    car_x = x;
+    car_y = y;
+    updateRearPos();
+
+    car_v = v;
+    car_yaw = yaw;
+    car_yaw2 = yaw;
+}
+
+// path points from first on changed (see updatePath in the header), spline them again
+void FollowerCore::pathChanged(size_t first)
+{
+    generateSplines(first);
+
+    //check if lap is complete
+    if (!plannerComplete && !centre_points.empty() && geometry::withinDist(Waypoint(initX,initY),centre_points.back(),0.02))
+    {
+        plannerComplete = true;
+        closeLap();
+    }
+}
+
+// the planner completed the lap: the closed spline and the track table are built on lap_thread,
+// until they are ready the car keeps following the open path
+void FollowerCore::closeLap()
+{
+    lap_points = centre_points;
+    // the last path point is the first one again (the car's initial position), the closed spline joins them itself
+    if (lap_points.size() > 1 && geometry::withinDist(lap_points.front(), lap_points.back(), 0.5))
+        lap_points.pop_back();
+    // the planner's limits: v_max and max_f_gain, or v_const everywhere (no curvature limit) with constant_v
+    float lap_v = constant_v ? v_const : v_max;
+    float lap_lat_acc = constant_v ? INFINITY : max_f_gain;
+    lap_thread = std::thread([this, lap_v, lap_lat_acc]
+    {
+        if (!track.build(lap_points.data(), lap_points.size(), lap_v, lap_lat_acc))
+        {
+            LOG_WARN("[FOLLOWER] track table not built, {} path points", lap_points.size());
+            return;
+        }
+        track_ready.store(true, std::memory_order_release);
+        LOG_INFO("[FOLLOWER] track table built, lap length {} m", track.length());
+    });
+}
+
+// compute linear and angular velocity commands
+// on the open path until the track table of the closed lap is ready, then from the table only
+void FollowerCore::DrivingControl()
+{
+    if (centre_points.size() <= 1) //no path points yet, or the path was reset to an empty keyframe
+        return; //to ignore rest of function
+	if (centre_points.size()<4)
+        currentGoalPoint.updatePoint(centre_points.front());
+    
+    double targetSpeed;
+    if (track_ready.load(std::memory_order_acquire))
+    {
+        // closed lap: goal point and speed limit from the track table
+        lapGoalPoint();
+        targetSpeed = currentGoalPoint.velocity;
+    }
+    else
+    {
+        double dist = getDistFromCar(currentGoalPoint);
+        while (dist > 50)
+        {
+            currentGoalPoint.updatePoint(Waypoint(car_x,car_y));
+            dist = getDistFromCar(currentGoalPoint);
+
+        }
+
+        // check if need to change goal pt 
+        if (Lf > dist) 
+            getGoalPoint();
+
+        if (endOfPath)
+            LOG_DEBUG("[FOLLOWER] end of path triggered!");
+        targetSpeed = (index >= 0) ? pathVelocity(goal_t) : 0;
+    }
+
+    // Acceleration Control
+    // P controller towards the velocity reference at the goal point (velocity profile of the planner,
+    // or the speed limit of the track table), both are limited to what the car can reach with MAX_ACC and MAX_DECEL
+    //can make this into a PID if needed
+    double acc = KP * (targetSpeed - car_v);
+	//constrain
+	if (acc >= MAX_ACC)
+		acc = MAX_ACC;
+	else if (acc <= MAX_DECEL)
+		acc =  MAX_DECEL;
+    
+    acceleration = acc;
+
+    // steering control
+    double alpha = getAngleFromCar(currentGoalPoint);
+    double steer = atan2((2 * LENGTH * sin(alpha)),Lf);
+    double targetSteer;
+    if (steer >= MAX_STEER)
+		targetSteer =   (MAX_STEER - 0.001); //copied from sanitise output
+	else if (steer <= -(MAX_STEER))
+		targetSteer =  -(MAX_STEER - 0.001);
+	else
+		targetSteer =  steer;
+
+    // so there is no abrupt changes in steering
+    if ((steering - targetSteer)<0)
+        steering += DELTA_STEER;
+    else if ((steering-targetSteer)>0)
+        steering -= DELTA_STEER;
+    else
+        steering = targetSteer;
+
+    // std::cout<<"acceleration: "<<acceleration<<" steering: "<<steering<<std::endl;
+}
+
+void FollowerCore::updateRearPos()
+{
+    rearX = car_x - ((LENGTH / 2) * cos(car_yaw2));
+	rearY = car_y - ((LENGTH / 2) * sin(car_yaw2));
+}
+
+//calculate distance of a point to the car
+double FollowerCore::getDistFromCar(Waypoint& pnt) 
+{
+    return geometry::dist<double>(car_x, car_y, pnt.x, pnt.y);
+}
+
+// calculate the angle of a point wrt car
+double FollowerCore::getAngleFromCar(Waypoint& pnt)
+{
+    double dX = pnt.x - rearX;
+	double dY = pnt.y - rearY;
+    return geometry::wrapAngle(atan2(dY,dX) - car_yaw2);
+}
+
+// velocity reference at spline parameter t (t = 0 at the first path point, 1 at the second...),
+// interpolated linearly between the path points
+float FollowerCore::pathVelocity(double t)
+{
+    size_t i = (size_t)t;
+    if (i + 1 >= centre_points.size())
+        return centre_points.back().velocity;
+    double f = t - std::floor(t);
+    return centre_points[i].velocity + f * (centre_points[i+1].velocity - centre_points[i].velocity);
+}
+
+/**********
+* This Function uses a centripetal Catmull-Rom chain (see path_segments.h)
+* Path points from path planner have metres of interval, they are splined to have a smoother path
+* segment i joins centre_points i and i+1 and only depends on points i-1 to i+2, so when the points from first on
+* changed only the segments from first-2 on are built again
+* the path is not sampled, the goal point search works on the segments (see getGoalPoint)
+* variables:
+* centre_points: path points from path planner
+* segments: segment i joins centre_points i and i+1
+***********/
+void FollowerCore::generateSplines(size_t first)
+{
+    size_t n = centre_points.size();
+    size_t seg = std::min((first >= 2) ? first - 2 : 0, segments.size());
+    segments.resize(seg);
+    for (; seg + 1 < n; seg++)
+        segments.push_back(catmullRomSegment(centre_points.data(), n, seg));
+    if (endOfPath && plannerComplete) LOG_INFO("[FOLLOWER] Splined last sections of the track!");
+}
+
+// points of the splined path, SEGMENT_SAMPLES per segment and the last path point (for rviz)
+void FollowerCore::samplePath(PathSamples &samples) const
+{
+    sampleSegments(segments, 0, 1.0 / SEGMENT_SAMPLES, segments.size() * SEGMENT_SAMPLES + 1, samples);
+}
+
+/*************
+* This function searches for the goal point on the splined path
+* the car is projected onto the path (local search from the last projection), then the goal point is where the
+* path leaves the circle of look ahead distance around the car, both solved on the segment cubics (path_segments.cpp)
+* The concept of look ahead distance of the pure puruit controller is used here
+*
+**/
+void FollowerCore::getGoalPoint()
+{
+    if (segments.empty())
+        return;
+
+    //step 1: project the car onto the path, searching from the last projection
+    size_t hint = (oldIndex == -1) ? 0 : oldIndex;
+    double t_car = projectOnPath(segments, car_x, car_y, hint);
+    oldIndex = hint;
+
+    //look ahead distance
+    Lf = LFC;
+    //if velocity is not constant, we can adjust lookahead dist using the formula:
+    // Lf = LFV * car_lin_v + LFC;
+
+    //step 2: where the path crosses the look ahead circle
+    if (lookaheadOnPath(segments, car_x, car_y, t_car, Lf, goal_t))
+    {
+        endOfPath = false;
+        index = std::min((size_t)goal_t, segments.size() - 1);
+        const SplineSegment &s = segments[index];
+        double u = goal_t - index;
+        double goal_x, goal_y, dx, dy, ddx, ddy, heading, curvature;
+        s.eval(u, goal_x, goal_y);
+        s.deriv(u, dx, dy);
+        s.deriv2(u, ddx, ddy);
+        headingCurvature(dx, dy, ddx, ddy, heading, curvature);
+        currentGoalPoint.updatePoint(goal_x, goal_y); //return value
+        currentGoalPoint.angle = heading;
+        currentGoalPoint.radius = (curvature != 0) ? 1 / curvature : INFINITY;
+    }
+    else //the path ends inside the circle
+    {
+        if (centre_points.size() > 5)
+            endOfPath = true;
+        index = segments.size();
+        goal_t = segments.size();
+        currentGoalPoint.updatePoint(centre_points.back());
+        LOG_DEBUG("[FOLLOWER] car near end of path");
+    }
+      
+}
+
+/*************
+* This function finds the goal point on the closed lap, once the track table is built (see closeLap)
+* the car is projected onto the table (search around the last projection), the goal point is look ahead distance
+* further along the track, all arc lengths wrap around at the start/finish line,
+* so the lap end needs no special case, crossing the line is only counted (s jumps back by more than half a lap)
+**/
+void FollowerCore::lapGoalPoint()
+{
+    double s_prev = (s_car < 0) ? track.length() : s_car;     // the table is built before the car reaches the line
+    s_car = track.project(car_x, car_y, s_car);
+    if (s_prev - s_car > track.length() / 2)
+    {
+        laps++;
+        if (!slowLapFinish)
+            LOG_INFO("[FOLLOWER] SLOW LAP FINISHED! waiting for fast lap ready...");
+        slowLapFinish = true;
+        LOG_DEBUG("[FOLLOWER] laps on the track table: {}", laps);
+    }
+
+    Lf = LFC;
+    track.at(s_car + Lf, currentGoalPoint);
+}
+
+// 
+double FollowerCore::getSign(double &num)
+{
+    if (num < 0)
+        return -1.0;
+    else 
+        return 1.0;
+}
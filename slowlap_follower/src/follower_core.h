@@ -0,0 +1,143 @@
+/**
+ * This is the follower core header file
+ * path splining, goal point search and pure pursuit control, without ROS
+ * once the planner completed the lap, the follower switches to the track table of the closed lap (track_table.h)
+ * follower.cpp (PathFollower) passes odometry and path msgs in and publishes acceleration/steering
+ * see comments for description of each member
+*/
+
+#ifndef SRC_FOLLOWER_CORE_H
+#define SRC_FOLLOWER_CORE_H
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "waypoint.h"               // waypoint struct
+#include "path_segments.h"         // Catmull-Rom segments of the path points
+#include "track_table.h"           // closed lap, tables by arc length
+#include <slowlap_common/log.h>     // LOG_DEBUG etc, debug messages can be compiled out (SLOWLAP_LOG_LEVEL)
+#include <slowlap_common/path_stream.h> // path msgs from the planner only carry the changes
+#include <slowlap_common/geometry.h>    // distances and angles
+#include <slowlap_common/vehicle_limits.h>  // MAX_ACC, MAX_DECEL, defaults of the speed params
+
+#define LENGTH 2.95                 // length of vehicle (front to rear wheel)
+#define G  9.81                     // gravity
+#define MAX_STEER 0.5//0.8          // Copied from Dennis  (MURauto20)
+#define SEGMENT_SAMPLES 10          // splined points per path segment, for rviz
+#define DT 0.05
+#define STOP_INDEX 2                // centre point where the car should stop
+#define DELTA_STEER 0.05            // change in steering angle
+
+//PID gains:
+#define KP 2
+#define KI 1
+#define KD  1
+
+//pure pursuit gains
+#define K 0.1
+#define LFV  0.1                // look forward gain
+#define LFC  3.5                // look ahead distance
+
+class FollowerCore
+{
+public:
+    FollowerCore();
+    ~FollowerCore();                    // waits for lap_thread
+    void updatePose(double, double, double, double);                    // car x, y, yaw, linear velocity (from odometry)
+    template <class Delta> bool updatePath(const Delta&);               // path stream msg (from planner), returns true if the path changed
+    void DrivingControl();             // acceleration and steering. see cpp file for description
+    void generateSplines(size_t);       // see cpp file for description
+    void samplePath(PathSamples&) const;    // splined path as points with heading and curvature, for rviz
+    void getGoalPoint();                // see cpp file for description
+    void clearVars();                   // clear temporary variables, vectors
+
+    bool slowLapFinish = false;
+
+    // speed params of the planner (same ROS params, see PathFollower), speed limit of the closed lap
+    bool constant_v = false;
+    float v_max = DEFAULT_V_MAX;
+    float v_const = DEFAULT_V_CONST;
+    float max_f_gain = DEFAULT_MAX_F_GAIN;
+
+    // actuation commands, publish to actuator
+    double acceleration=0;
+    double steering=0;
+
+protected:
+    PathStreamReader path_stream;       // sequence of the path msgs
+    void pathChanged(size_t);           // re-spline after the path changed from the given point on
+    void closeLap();                    // the planner completed the lap, builds the track table on lap_thread
+    void lapGoalPoint();                // goal point from the track table, see cpp file
+    double Lf = LFC;                    // look ahead distance, can be adjusted, see code
+
+    double car_x;                       // car pose x
+    double car_y;                       // car pose y
+    double car_v;                       // car linear velocity
+    double car_yaw;                     // car yaw in Euler angle
+    double car_yaw2;                    // different formula for yaw. works somehow
+    double initX = 0;                   // initial pos x
+    double initY = 0;                   // initial pos y
+    double initYaw = 0;                 // initial yaw
+    double rearX, rearY;
+    bool initialised = false;
+
+    bool new_centre_points = false;
+    int cenPoints_updated = 0;
+
+    std::vector<Waypoint> centre_points;        // centre line points of race tack, from path planner
+    Waypoint currentGoalPoint = Waypoint(0,0);
+
+    std::vector<SplineSegment> segments;        // segment i joins centre_points i and i+1, see generateSplines()
+
+    bool newGP = false;
+    bool endOfPath = false;
+    bool stopSpline = false;
+    bool plannerComplete = false;
+    int index = -1;                              // segment of the goal point, -1 before the first goal point
+    int oldIndex = -1;                           // segment nearest the car (start of the next search)
+    double goal_t = 0;                           // goal point on the path, segment + u (see path_segments.h)
+
+    TrackTable track;                           // closed lap, built by lap_thread, read-only once track_ready
+    std::vector<Waypoint> lap_points;           // centre_points of the completed lap, for lap_thread
+    std::thread lap_thread;
+    std::atomic<bool> track_ready{false};       // set by lap_thread when track is built
+    double s_car = -1;                          // arc length of the car on track, -1 before the first projection
+    int laps = 0;                               // start/finish line crossings on track
+
+    void updateRearPos();
+    float pathVelocity(double);          // velocity of centre_points at a spline parameter, see cpp file
+    double getDistFromCar(Waypoint&);    // to compute distance of point to current car pose
+    double getAngleFromCar(Waypoint&);   // to compute angle differene of a point to current car yaw
+    double getSign(double&);
+};
+
+// applies one msg of the planner's path stream (see slowlap_common/path_stream.h)
+// only the retracted and appended points are touched, msgs that do not fit are dropped until the next keyframe
+template <class Delta>
+bool FollowerCore::updatePath(const Delta &delta)
+{
+    if (!path_stream.accept(delta, centre_points.size()))
+    {
+        LOG_WARN("[FOLLOWER] path msg {} dropped, waiting for keyframe", delta.seq);
+        return false;
+    }
+    size_t keep = PathStreamReader::keep(delta, centre_points);
+    size_t first = PathStreamReader::firstNew(delta, keep);
+    if (keep == centre_points.size() && first == delta.x.size())
+        return false;   // nothing changed (e.g. keyframe of the same path)
+
+    centre_points.erase(centre_points.begin() + keep, centre_points.end());
+    for (size_t i = first; i < delta.x.size(); i++)
+    {
+        centre_points.emplace_back(delta.x[i], delta.y[i]);
+        centre_points.back().velocity = delta.v[i];
+    }
+    new_centre_points = true;
+    pathChanged(keep);
+    return true;
+}
+
+#endif // SRC_FOLLOWER_CORE_H
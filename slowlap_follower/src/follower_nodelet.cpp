@@ -0,0 +1,34 @@
+/**
+ * This is the path follower as a nodelet
+ * runs PathFollower inside a nodelet manager, so path msgs from the planner nodelet
+ * arrive as pointers instead of being serialised (see slowlap_planner/launch/slow_lap_nodelets.launch)
+ * max_v and max_w are passed as nodelet arguments, like the slowlap_follower executable
+**/
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include "follower.h"
+
+namespace slowlap_follower
+{
+
+class FollowerNodelet : public nodelet::Nodelet
+{
+private:
+    std::unique_ptr<PathFollower> follower;
+
+    void onInit() override
+    {
+        const std::vector<std::string> &argv = getMyArgv();
+        double max_v = (argv.size() > 0) ? atof(argv[0].c_str()) : MAX_V;
+        double max_w = (argv.size() > 1) ? atof(argv[1].c_str()) : MAX_W;
+
+        // timer and callbacks run on this nodelet's queue, the follower does not shut ROS down when it stops
+        follower.reset(new PathFollower(getNodeHandle(), max_v, max_w, false));
+        NODELET_INFO_STREAM("[FOLLOWER] nodelet loaded");
+    }
+};
+
+} // namespace slowlap_follower
+
+PLUGINLIB_EXPORT_CLASS(slowlap_follower::FollowerNodelet, nodelet::Nodelet)
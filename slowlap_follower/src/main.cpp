@@ -0,0 +1,19 @@
+#include <ros/ros.h>
+#include "follower.h"
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "PathFollower"); 
+    ros::NodeHandle n;
+       
+         // Get parameters from CLI
+    double max_v = atof(argv[1]);
+    double max_w = atof(argv[2]);
+    
+    //Initialize Husky Object
+    
+    PathFollower follower(n,max_v, max_w);
+    ros::spin();    // control runs on a timer (see follower.cpp)
+    return 0;
+    
+}
\ No newline at end of file
@@ -0,0 +1,349 @@
+/**
+ * queries of the follower on the Catmull-Rom chain, see path_segments.h
+ * both solve for u inside one segment with Newton's method, kept inside a bracket (bisection if a step leaves it),
+ * a handful of iterations reach micrometres since the segments are short and nearly straight
+ * the sampling kernel picks its instruction set at compile time (-mavx / -march=native for AVX, SSE2 is always there on x86-64),
+ * every lane can be in a different segment, its coefficients are gathered per lane (usually all lanes share one segment)
+ **/
+
+#include "path_segments.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define NEWTON_ITERATIONS 8
+#define NEWTON_TOLERANCE 1e-9       // in u
+
+#define HALF_PI 1.5707963267948966
+#define PI 3.141592653589793
+
+// minimax polynomial for atan on [0, 1], coefficients of a, a^3, ... a^11 (same as the planner's edge_cost.cpp)
+#define ATAN_C0 0.99997726
+#define ATAN_C1 -0.33262347
+#define ATAN_C2 0.19354346
+#define ATAN_C3 -0.11643287
+#define ATAN_C4 0.05265332
+#define ATAN_C5 -0.01172120
+
+// squared distance from (x, y) to the nearest point of the segment, u of that point in u_out
+static double nearestOnSegment(const SplineSegment &s, double x, double y, double &u_out)
+{
+    // start from the projection onto the chord, then Newton on g(u) = (p(u) - q) . p'(u) = 0
+    double ex, ey;
+    s.eval(1, ex, ey);
+    double cx = ex - s.ax, cy = ey - s.ay;
+    double len2 = cx * cx + cy * cy;
+    double u = (len2 > 0) ? ((x - s.ax) * cx + (y - s.ay) * cy) / len2 : 0;
+    u = std::min(1.0, std::max(0.0, u));
+    for (int k = 0; k < NEWTON_ITERATIONS; k++)
+    {
+        double px, py, dx, dy, ddx, ddy;
+        s.eval(u, px, py);
+        s.deriv(u, dx, dy);
+        s.deriv2(u, ddx, ddy);
+        double g = (px - x) * dx + (py - y) * dy;
+        double dg = dx * dx + dy * dy + (px - x) * ddx + (py - y) * ddy;
+        if (dg <= 0)
+            break;      // not convex here, keep the best so far
+        double next = std::min(1.0, std::max(0.0, u - g / dg));
+        bool done = std::fabs(next - u) < NEWTON_TOLERANCE;
+        u = next;
+        if (done)
+            break;
+    }
+    double px, py;
+    s.eval(u, px, py);
+    double d = (px - x) * (px - x) + (py - y) * (py - y);
+    // the ends can be nearer if the iteration went to a local minimum
+    for (double end = 0; end <= 1; end += 1)
+    {
+        s.eval(end, px, py);
+        double d_end = (px - x) * (px - x) + (py - y) * (py - y);
+        if (d_end < d)
+        {
+            d = d_end;
+            u = end;
+        }
+    }
+    u_out = u;
+    return d;
+}
+
+double projectOnPath(const std::vector<SplineSegment> &segments, double x, double y, size_t &hint)
+{
+    if (segments.empty())
+        return 0;
+    size_t i = std::min(hint, segments.size() - 1);
+    double u;
+    double d = nearestOnSegment(segments[i], x, y, u);
+    bool moved = false;
+    while (i + 1 < segments.size())
+    {
+        double u_next;
+        double d_next = nearestOnSegment(segments[i+1], x, y, u_next);
+        if (d_next > d)
+            break;
+        i++;
+        d = d_next;
+        u = u_next;
+        moved = true;
+    }
+    while (!moved && i > 0)
+    {
+        double u_prev;
+        double d_prev = nearestOnSegment(segments[i-1], x, y, u_prev);
+        if (d_prev >= d)
+            break;
+        i--;
+        d = d_prev;
+        u = u_prev;
+    }
+    hint = i;
+    return i + u;
+}
+
+// f(u) = |p(u) - q|^2 - r^2 and its derivative
+static double circleDist(const SplineSegment &s, double x, double y, double r2, double u, double &df)
+{
+    double px, py, dx, dy;
+    s.eval(u, px, py);
+    s.deriv(u, dx, dy);
+    df = 2 * ((px - x) * dx + (py - y) * dy);
+    return (px - x) * (px - x) + (py - y) * (py - y) - r2;
+}
+
+bool lookaheadOnPath(const std::vector<SplineSegment> &segments, double x, double y, double t_from, double radius, double &t_out)
+{
+    double r2 = radius * radius;
+    size_t first = (t_from > 0) ? (size_t)t_from : 0;
+    for (size_t i = first; i < segments.size(); i++)
+    {
+        const SplineSegment &s = segments[i];
+        // the whole segment is inside the circle, it cannot cross it
+        if (std::hypot(s.bound_x - x, s.bound_y - y) + s.bound_r < radius)
+            continue;
+
+        double df;
+        double lo = (i == first) ? std::max(0.0, t_from - i) : 0;
+        double f_lo = circleDist(s, x, y, r2, lo, df);
+        if (f_lo >= 0)
+        {
+            t_out = i + lo;     // already outside (car off the path by more than radius)
+            return true;
+        }
+        double hi = 1;
+        double f_hi = circleDist(s, x, y, r2, hi, df);
+        if (f_hi < 0)
+            continue;           // ends inside the circle again, the crossing is in a later segment
+
+        // f(lo) < 0 <= f(hi): Newton from the linear interpolation of f, bisection when a step leaves [lo, hi]
+        double u = lo - f_lo * (hi - lo) / (f_hi - f_lo);
+        for (int k = 0; k < NEWTON_ITERATIONS; k++)
+        {
+            double f = circleDist(s, x, y, r2, u, df);
+            if (df > 0 && std::fabs(f) < NEWTON_TOLERANCE * df)
+                break;          // the next step would be below the tolerance
+            if (f < 0)
+                lo = u;
+            else
+                hi = u;
+            u = (df > 0) ? u - f / df : lo - 1;
+            if (u <= lo || u >= hi)
+                u = (lo + hi) / 2;
+        }
+        t_out = i + u;
+        return true;
+    }
+    return false;
+}
+
+void PathSamples::resize(size_t n)
+{
+    x.resize(n);
+    y.resize(n);
+    heading.resize(n);
+    curvature.resize(n);
+}
+
+// segment and u of the sample at t, the cursor seg only moves forward (t grows)
+static inline double sampleSegment(size_t n_seg, double t, size_t &seg)
+{
+    t = std::min((double)n_seg, std::max(0.0, t));
+    while (seg + 1 < n_seg && t >= seg + 1)
+        seg++;
+    return t - seg;
+}
+
+// samples from..n-1, one at a time
+static void sampleFrom(const std::vector<SplineSegment> &segments, double t_from, double step, size_t from, size_t n,
+                       size_t seg, PathSamples &out)
+{
+    for (size_t k = from; k < n; k++)
+    {
+        double u = sampleSegment(segments.size(), t_from + k * step, seg);
+        const SplineSegment &s = segments[seg];
+        double dx, dy, ddx, ddy;
+        s.eval(u, out.x[k], out.y[k]);
+        s.deriv(u, dx, dy);
+        s.deriv2(u, ddx, ddy);
+        headingCurvature(dx, dy, ddx, ddy, out.heading[k], out.curvature[k]);
+    }
+}
+
+void sampleSegmentsScalar(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &samples)
+{
+    samples.resize(segments.empty() ? 0 : n);
+    if (!segments.empty())
+        sampleFrom(segments, t_from, step, 0, n, 0, samples);
+}
+
+#if defined(__AVX__)
+
+static inline __m256d atan2_avx(__m256d y, __m256d x)
+{
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d ax = _mm256_andnot_pd(sign, x);
+    __m256d ay = _mm256_andnot_pd(sign, y);
+    __m256d hi = _mm256_max_pd(_mm256_max_pd(ax, ay), _mm256_set1_pd(1e-300));
+    __m256d a = _mm256_div_pd(_mm256_min_pd(ax, ay), hi);
+    __m256d s = _mm256_mul_pd(a, a);
+    __m256d r = _mm256_set1_pd(ATAN_C5);
+    r = _mm256_add_pd(_mm256_mul_pd(r, s), _mm256_set1_pd(ATAN_C4));
+    r = _mm256_add_pd(_mm256_mul_pd(r, s), _mm256_set1_pd(ATAN_C3));
+    r = _mm256_add_pd(_mm256_mul_pd(r, s), _mm256_set1_pd(ATAN_C2));
+    r = _mm256_add_pd(_mm256_mul_pd(r, s), _mm256_set1_pd(ATAN_C1));
+    r = _mm256_add_pd(_mm256_mul_pd(r, s), _mm256_set1_pd(ATAN_C0));
+    r = _mm256_mul_pd(r, a);
+    r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(HALF_PI), r), _mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_pd(r, _mm256_sub_pd(_mm256_set1_pd(PI), r), _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ));
+    return _mm256_or_pd(r, _mm256_and_pd(sign, y));
+}
+
+void sampleSegments(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &out)
+{
+    if (segments.empty())
+    {
+        out.resize(0);
+        return;
+    }
+    out.resize(n);
+    const __m256d two = _mm256_set1_pd(2), three = _mm256_set1_pd(3), six = _mm256_set1_pd(6);
+    size_t seg = 0;
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        const SplineSegment *s[4];
+        double u[4];
+        for (int l = 0; l < 4; l++)
+        {
+            u[l] = sampleSegment(segments.size(), t_from + (k + l) * step, seg);
+            s[l] = &segments[seg];
+        }
+#define LANES(c) _mm256_set_pd(s[3]->c, s[2]->c, s[1]->c, s[0]->c)
+        __m256d vu = _mm256_loadu_pd(u);
+        __m256d ax = LANES(ax), bx = LANES(bx), cx = LANES(cx), dx = LANES(dx);
+        __m256d ay = LANES(ay), by = LANES(by), cy = LANES(cy), dy = LANES(dy);
+#undef LANES
+        // Horner for the cubic and its derivatives
+        __m256d x = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(dx, vu), cx), vu), bx), vu), ax);
+        __m256d y = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(dy, vu), cy), vu), by), vu), ay);
+        __m256d x1 = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(three, dx), vu), _mm256_mul_pd(two, cx)), vu), bx);
+        __m256d y1 = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(three, dy), vu), _mm256_mul_pd(two, cy)), vu), by);
+        __m256d x2 = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(six, dx), vu), _mm256_mul_pd(two, cx));
+        __m256d y2 = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(six, dy), vu), _mm256_mul_pd(two, cy));
+
+        __m256d v2 = _mm256_add_pd(_mm256_mul_pd(x1, x1), _mm256_mul_pd(y1, y1));
+        __m256d cross = _mm256_sub_pd(_mm256_mul_pd(x1, y2), _mm256_mul_pd(y1, x2));
+        __m256d curvature = _mm256_div_pd(cross, _mm256_mul_pd(v2, _mm256_sqrt_pd(v2)));
+        curvature = _mm256_and_pd(_mm256_cmp_pd(v2, _mm256_setzero_pd(), _CMP_GT_OQ), curvature);
+
+        _mm256_storeu_pd(&out.x[k], x);
+        _mm256_storeu_pd(&out.y[k], y);
+        _mm256_storeu_pd(&out.heading[k], atan2_avx(y1, x1));
+        _mm256_storeu_pd(&out.curvature[k], curvature);
+    }
+    sampleFrom(segments, t_from, step, k, n, seg, out);
+}
+
+#elif defined(__SSE2__)
+
+// a where mask is set, else b (SSE2 has no blendv)
+static inline __m128d select_sse(__m128d mask, __m128d a, __m128d b)
+{
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+static inline __m128d atan2_sse(__m128d y, __m128d x)
+{
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d ax = _mm_andnot_pd(sign, x);
+    __m128d ay = _mm_andnot_pd(sign, y);
+    __m128d hi = _mm_max_pd(_mm_max_pd(ax, ay), _mm_set1_pd(1e-300));
+    __m128d a = _mm_div_pd(_mm_min_pd(ax, ay), hi);
+    __m128d s = _mm_mul_pd(a, a);
+    __m128d r = _mm_set1_pd(ATAN_C5);
+    r = _mm_add_pd(_mm_mul_pd(r, s), _mm_set1_pd(ATAN_C4));
+    r = _mm_add_pd(_mm_mul_pd(r, s), _mm_set1_pd(ATAN_C3));
+    r = _mm_add_pd(_mm_mul_pd(r, s), _mm_set1_pd(ATAN_C2));
+    r = _mm_add_pd(_mm_mul_pd(r, s), _mm_set1_pd(ATAN_C1));
+    r = _mm_add_pd(_mm_mul_pd(r, s), _mm_set1_pd(ATAN_C0));
+    r = _mm_mul_pd(r, a);
+    r = select_sse(_mm_cmpgt_pd(ay, ax), _mm_sub_pd(_mm_set1_pd(HALF_PI), r), r);
+    r = select_sse(_mm_cmplt_pd(x, _mm_setzero_pd()), _mm_sub_pd(_mm_set1_pd(PI), r), r);
+    return _mm_or_pd(r, _mm_and_pd(sign, y));
+}
+
+void sampleSegments(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &out)
+{
+    if (segments.empty())
+    {
+        out.resize(0);
+        return;
+    }
+    out.resize(n);
+    const __m128d two = _mm_set1_pd(2), three = _mm_set1_pd(3), six = _mm_set1_pd(6);
+    size_t seg = 0;
+    size_t k = 0;
+    for (; k + 2 <= n; k += 2)
+    {
+        double u0 = sampleSegment(segments.size(), t_from + k * step, seg);
+        const SplineSegment &s0 = segments[seg];
+        double u1 = sampleSegment(segments.size(), t_from + (k + 1) * step, seg);
+        const SplineSegment &s1 = segments[seg];
+#define LANES(c) _mm_set_pd(s1.c, s0.c)
+        __m128d vu = _mm_set_pd(u1, u0);
+        __m128d ax = LANES(ax), bx = LANES(bx), cx = LANES(cx), dx = LANES(dx);
+        __m128d ay = LANES(ay), by = LANES(by), cy = LANES(cy), dy = LANES(dy);
+#undef LANES
+        // Horner for the cubic and its derivatives
+        __m128d x = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(dx, vu), cx), vu), bx), vu), ax);
+        __m128d y = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(dy, vu), cy), vu), by), vu), ay);
+        __m128d x1 = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_mul_pd(three, dx), vu), _mm_mul_pd(two, cx)), vu), bx);
+        __m128d y1 = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_mul_pd(three, dy), vu), _mm_mul_pd(two, cy)), vu), by);
+        __m128d x2 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(six, dx), vu), _mm_mul_pd(two, cx));
+        __m128d y2 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(six, dy), vu), _mm_mul_pd(two, cy));
+
+        __m128d v2 = _mm_add_pd(_mm_mul_pd(x1, x1), _mm_mul_pd(y1, y1));
+        __m128d cross = _mm_sub_pd(_mm_mul_pd(x1, y2), _mm_mul_pd(y1, x2));
+        __m128d curvature = _mm_div_pd(cross, _mm_mul_pd(v2, _mm_sqrt_pd(v2)));
+        curvature = _mm_and_pd(_mm_cmpgt_pd(v2, _mm_setzero_pd()), curvature);
+
+        _mm_storeu_pd(&out.x[k], x);
+        _mm_storeu_pd(&out.y[k], y);
+        _mm_storeu_pd(&out.heading[k], atan2_sse(y1, x1));
+        _mm_storeu_pd(&out.curvature[k], curvature);
+    }
+    sampleFrom(segments, t_from, step, k, n, seg, out);
+}
+
+#else
+
+void sampleSegments(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &samples)
+{
+    sampleSegmentsScalar(segments, t_from, step, n, samples);
+}
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * This is the centripetal Catmull-Rom chain of the follower
+ * segment i joins path points i and i+1, its shape only depends on points i-1 to i+2 (local support),
+ * so a new or retracted path point changes only the segment before it and the one after (see FollowerCore::generateSplines)
+ * centripetal: the knots are spaced by the square root of the point distances, no cusps or loops with uneven spacing
+ * the chain goes through every path point and is smooth (C1) at the joins
+ * each segment is stored as a cubic in u = 0..1 per coordinate and evaluated with Horner's rule
+ * a point on the chain is given by t = segment + u, the queries of the follower work on the cubics directly
+ * (path_segments.cpp), with a bounding circle per segment to skip the segments that cannot be hit:
+ * - projectOnPath(): car position -> t of the nearest point, local search from the last result, Newton in the segment
+ * - lookaheadOnPath(): first point after t at a given distance from the car (pure pursuit goal), Newton in the segment
+ * - sampleSegments(): points at evenly spaced t with heading and curvature, several samples per instruction
+ *   (4 with AVX, 2 with SSE2, else one by one), a cursor walks the segments since t only grows
+ *
+ * usage:   SplineSegment s = catmullRomSegment(points.data(), points.size(), i);
+ *          s.eval(0.5, x, y);
+**/
+
+#ifndef SRC_PATH_SEGMENTS_H
+#define SRC_PATH_SEGMENTS_H
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+#define SEGMENT_MIN_LENGTH 1e-4     // points closer than this (m) are taken as the same point
+
+struct SplineSegment
+{
+    // a + b*u + c*u^2 + d*u^3
+    double ax, bx, cx, dx;
+    double ay, by, cy, dy;
+    // circle around the whole segment (its Bezier control points), see bound()
+    double bound_x, bound_y, bound_r;
+
+    void eval(double u, double &x, double &y) const
+    {
+        x = ((dx * u + cx) * u + bx) * u + ax;
+        y = ((dy * u + cy) * u + by) * u + ay;
+    }
+
+    // first derivative (dx/du, dy/du)
+    void deriv(double u, double &x, double &y) const
+    {
+        x = (3 * dx * u + 2 * cx) * u + bx;
+        y = (3 * dy * u + 2 * cy) * u + by;
+    }
+
+    // second derivative
+    void deriv2(double u, double &x, double &y) const
+    {
+        x = 6 * dx * u + 2 * cx;
+        y = 6 * dy * u + 2 * cy;
+    }
+
+    // the segment lies inside the convex hull of its Bezier control points, so inside a circle around them
+    void bound()
+    {
+        double px[4] = {ax, ax + bx / 3, ax + (2 * bx + cx) / 3, ax + bx + cx + dx};
+        double py[4] = {ay, ay + by / 3, ay + (2 * by + cy) / 3, ay + by + cy + dy};
+        bound_x = (px[0] + px[3]) / 2;
+        bound_y = (py[0] + py[3]) / 2;
+        bound_r = 0;
+        for (int k = 0; k < 4; k++)
+            bound_r = std::max(bound_r, std::hypot(px[k] - bound_x, py[k] - bound_y));
+    }
+};
+
+// heading (rad) and curvature (1/radius, > 0 for a left turn) from the first and second derivative
+inline void headingCurvature(double dx, double dy, double ddx, double ddy, double &heading, double &curvature)
+{
+    heading = std::atan2(dy, dx);
+    double v2 = dx * dx + dy * dy;
+    curvature = (v2 > 0) ? (dx * ddy - dy * ddx) / (v2 * std::sqrt(v2)) : 0;
+}
+
+// samples of the chain, one array per quantity (outputs of sampleSegments())
+struct PathSamples
+{
+    std::vector<double> x, y;
+    std::vector<double> heading;        // direction of the path (rad)
+    std::vector<double> curvature;      // 1/radius, > 0 for a left turn
+
+    void resize(size_t n);
+    size_t size() const { return x.size(); }
+};
+
+// fills samples with the n points at t = t_from + k*step (step >= 0), t is clamped to the chain [0, segments.size()]
+// the SIMD versions use a polynomial atan2 for the heading (error < 1e-5 rad), the scalar version std::atan2
+void sampleSegments(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &samples);
+
+// same, one sample at a time, for checking the SIMD versions
+void sampleSegmentsScalar(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n, PathSamples &samples);
+
+// t of the point of the chain nearest to (x, y), the search starts in segment hint and follows the distance downhill,
+// hint is set to the segment found
+double projectOnPath(const std::vector<SplineSegment> &segments, double x, double y, size_t &hint);
+
+// first point after t_from that is radius away from (x, y), its t in t_out
+// (t_from if that point is already radius away), false if the chain ends inside the circle
+bool lookaheadOnPath(const std::vector<SplineSegment> &segments, double x, double y, double t_from, double radius, double &t_out);
+
+// segment from points[i] to points[i+1] of a path of n points (0 <= i < n-1)
+// before the first and after the last point a point is mirrored, so the ends are straight
+template <class P>
+SplineSegment catmullRomSegment(const P *points, int n, int i)
+{
+    double x1 = points[i].x, y1 = points[i].y;
+    double x2 = points[i+1].x, y2 = points[i+1].y;
+    double d1 = std::sqrt(std::hypot(x2 - x1, y2 - y1));
+    SplineSegment s = {x1, 0, 0, 0, y1, 0, 0, 0, x1, y1, 0};
+    if (d1 * d1 < SEGMENT_MIN_LENGTH)
+        return s;       // the same point twice, the segment is that point
+
+    // neighbours, mirrored at the ends of the path and for repeated points
+    double x0 = 2 * x1 - x2, y0 = 2 * y1 - y2;
+    if (i > 0 && std::hypot(points[i-1].x - x1, points[i-1].y - y1) >= SEGMENT_MIN_LENGTH)
+    {
+        x0 = points[i-1].x;
+        y0 = points[i-1].y;
+    }
+    double x3 = 2 * x2 - x1, y3 = 2 * y2 - y1;
+    if (i + 2 < n && std::hypot(points[i+2].x - x2, points[i+2].y - y2) >= SEGMENT_MIN_LENGTH)
+    {
+        x3 = points[i+2].x;
+        y3 = points[i+2].y;
+    }
+    double d0 = std::sqrt(std::hypot(x1 - x0, y1 - y0));
+    double d2 = std::sqrt(std::hypot(x3 - x2, y3 - y2));
+
+    // tangents at points i and i+1 for the knot spacing d0, d1, d2, scaled to u = 0..1 (times d1)
+    double mx1 = ((x1 - x0) / d0 - (x2 - x0) / (d0 + d1) + (x2 - x1) / d1) * d1;
+    double my1 = ((y1 - y0) / d0 - (y2 - y0) / (d0 + d1) + (y2 - y1) / d1) * d1;
+    double mx2 = ((x2 - x1) / d1 - (x3 - x1) / (d1 + d2) + (x3 - x2) / d2) * d1;
+    double my2 = ((y2 - y1) / d1 - (y3 - y1) / (d1 + d2) + (y3 - y2) / d2) * d1;
+
+    // Hermite segment as a cubic
+    s.bx = mx1;
+    s.by = my1;
+    s.cx = 3 * (x2 - x1) - 2 * mx1 - mx2;
+    s.cy = 3 * (y2 - y1) - 2 * my1 - my2;
+    s.dx = 2 * (x1 - x2) + mx1 + mx2;
+    s.dy = 2 * (y1 - y2) + my1 + my2;
+    s.bound();
+    return s;
+}
+
+#endif // SRC_PATH_SEGMENTS_H
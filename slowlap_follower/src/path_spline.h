@@ -0,0 +1,147 @@
+/**
+ * This is the closed cubic spline of the follower, fitted over the whole lap at once (see track_table.h)
+ * (the path that is still growing uses local Catmull-Rom segments instead, see path_segments.h)
+ * periodic cubic spline through path points 0..n-1 at t = 0, 1, 2... (one unit per path point) and back to point 0 at t = n,
+ * x(t) and y(t) fitted together: both have the same cyclic tridiagonal system, it is solved once for both right hand sides
+ * with the Thomas algorithm and a Sherman-Morrison correction for the corners
+ * the coefficients are sized by fitClosed() for the n points of the lap (it runs off the control path, see track_table.h),
+ * eval() never allocates
+ * t wraps around (any t is on the loop)
+ *
+ * usage:   PathSpline spline;                  // member of the caller, reused for every fit
+ *          if (spline.fitClosed(points.data(), n)) spline.eval(t, x, y);
+**/
+
+#ifndef SRC_PATH_SPLINE_H
+#define SRC_PATH_SPLINE_H
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+class PathSpline
+{
+public:
+    // closed spline through points[0..n-1] (any type with x and y) and back to points[0],
+    // false if n < 3
+    template <class P> bool fitClosed(const P *points, int n);
+
+    // point at parameter t
+    void eval(double t, double &x, double &y) const;
+
+    // first and second derivative at parameter t
+    void derivatives(double t, double &dx, double &dy, double &ddx, double &ddy) const;
+
+    int size() const { return n; }
+
+private:
+    int n = 0;
+    // segment i: a + b*u + c*u^2 + d*u^3, u = t - i
+    std::vector<double> ax, bx, cx, dx;
+    std::vector<double> ay, by, cy, dy;
+    std::vector<double> w;          // Thomas algorithm: eliminated upper diagonal
+
+    double wrap(double t) const;        // t into [0, n)
+    int segment(double t) const;        // segment of a wrapped t
+};
+
+template <class P>
+bool PathSpline::fitClosed(const P *points, int count)
+{
+    if (count < 3)
+        return false;
+    n = count;
+    for (std::vector<double> *c: {&ax, &bx, &cx, &dx, &ay, &by, &cy, &dy, &w})
+        c->resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        ax[i] = points[i].x;
+        ay[i] = points[i].y;
+    }
+
+    // c[i-1] + 4c[i] + c[i+1] = 3(a[i+1] - 2a[i] + a[i-1]) for every point, indices wrap around
+    // the corners (1 in the first and last row) are split off as u*v^T with u = (-4, 0.., 1), v = (1, 0.., -1/4),
+    // the rest is tridiagonal with diagonal 8, 4.., 4.25 and solved for the right hand sides and for u (kept in dx)
+    for (int i = 0; i < n; i++)
+    {
+        int prev = (i + n - 1) % n, next = (i + 1) % n;
+        cx[i] = 3 * (ax[next] - 2 * ax[i] + ax[prev]);
+        cy[i] = 3 * (ay[next] - 2 * ay[i] + ay[prev]);
+        dx[i] = 0;
+    }
+    dx[0] = -4;
+    dx[n-1] = 1;
+    // forward elimination
+    double diag = 8;
+    w[0] = 1 / diag;
+    cx[0] /= diag;
+    cy[0] /= diag;
+    dx[0] /= diag;
+    for (int i = 1; i < n; i++)
+    {
+        diag = ((i == n - 1) ? 4.25 : 4) - w[i-1];
+        w[i] = 1 / diag;
+        cx[i] = (cx[i] - cx[i-1]) / diag;
+        cy[i] = (cy[i] - cy[i-1]) / diag;
+        dx[i] = (dx[i] - dx[i-1]) / diag;
+    }
+    // back substitution
+    for (int i = n - 2; i >= 0; i--)
+    {
+        cx[i] -= w[i] * cx[i+1];
+        cy[i] -= w[i] * cy[i+1];
+        dx[i] -= w[i] * dx[i+1];
+    }
+    // Sherman-Morrison: c -= z * (v.c) / (1 + v.z)
+    double vz = 1 + dx[0] - dx[n-1] / 4;
+    double fx = (cx[0] - cx[n-1] / 4) / vz;
+    double fy = (cy[0] - cy[n-1] / 4) / vz;
+    for (int i = 0; i < n; i++)
+    {
+        cx[i] -= fx * dx[i];
+        cy[i] -= fy * dx[i];
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        int next = (i + 1) % n;
+        bx[i] = ax[next] - ax[i] - (2 * cx[i] + cx[next]) / 3;
+        by[i] = ay[next] - ay[i] - (2 * cy[i] + cy[next]) / 3;
+        dx[i] = (cx[next] - cx[i]) / 3;
+        dy[i] = (cy[next] - cy[i]) / 3;
+    }
+    return true;
+}
+
+inline double PathSpline::wrap(double t) const
+{
+    t = std::fmod(t, n);
+    return (t < 0) ? t + n : t;
+}
+
+inline int PathSpline::segment(double t) const
+{
+    return std::min((int)t, n - 1);     // t == n only by rounding in wrap()
+}
+
+inline void PathSpline::eval(double t, double &x, double &y) const
+{
+    t = wrap(t);
+    int i = segment(t);
+    double u = t - i;
+    x = ((dx[i] * u + cx[i]) * u + bx[i]) * u + ax[i];
+    y = ((dy[i] * u + cy[i]) * u + by[i]) * u + ay[i];
+}
+
+inline void PathSpline::derivatives(double t, double &x1, double &y1, double &x2, double &y2) const
+{
+    t = wrap(t);
+    int i = segment(t);
+    double u = t - i;
+    x1 = (3 * dx[i] * u + 2 * cx[i]) * u + bx[i];
+    y1 = (3 * dy[i] * u + 2 * cy[i]) * u + by[i];
+    x2 = 6 * dx[i] * u + 2 * cx[i];
+    y2 = 6 * dy[i] * u + 2 * cy[i];
+}
+
+#endif // SRC_PATH_SPLINE_H
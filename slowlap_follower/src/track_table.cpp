@@ -0,0 +1,176 @@
+/**
+ * table of the closed track, see track_table.h
+ * the arc length of the spline is measured with chords between TABLE_SUBSTEPS samples per path point,
+ * the table samples are placed at even arc length by interpolating t between those samples
+ **/
+
+#include "track_table.h"
+#include <algorithm>
+#include "path_segments.h"              // headingCurvature()
+#include <slowlap_common/geometry.h>
+#include <slowlap_common/vehicle_limits.h>  // MAX_ACC, MAX_DECEL
+
+bool TrackTable::build(const Waypoint *points, size_t n, float v_max, float lat_acc)
+{
+    if (!spline.fitClosed(points, (int)n))
+        return false;
+
+    // arc length at t = k / TABLE_SUBSTEPS, up to t = n (back at the first point)
+    size_t m = n * TABLE_SUBSTEPS;
+    sub_t.resize(m + 1);
+    sub_s.resize(m + 1);
+    double px, py, qx, qy;
+    spline.eval(0, px, py);
+    sub_t[0] = 0;
+    sub_s[0] = 0;
+    for (size_t k = 1; k <= m; k++)
+    {
+        sub_t[k] = (double)k / TABLE_SUBSTEPS;
+        spline.eval(sub_t[k], qx, qy);
+        sub_s[k] = sub_s[k-1] + geometry::dist(px, py, qx, qy);
+        px = qx;
+        py = qy;
+    }
+    lap_length = sub_s[m];
+    size_t count = std::max<size_t>(1, (size_t)std::round(lap_length / TABLE_STEP));
+    step = lap_length / count;
+
+    x.resize(count);
+    y.resize(count);
+    heading.resize(count);
+    curvature.resize(count);
+    v.resize(count);
+    size_t k = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double s = i * step;
+        while (k + 1 < m && sub_s[k+1] <= s)
+            k++;
+        double f = (sub_s[k+1] > sub_s[k]) ? (s - sub_s[k]) / (sub_s[k+1] - sub_s[k]) : 0;
+        double t = sub_t[k] + f * (sub_t[k+1] - sub_t[k]);
+        double dx, dy, ddx, ddy, h, c;
+        spline.eval(t, px, py);
+        spline.derivatives(t, dx, dy, ddx, ddy);
+        headingCurvature(dx, dy, ddx, ddy, h, c);
+        x[i] = px;
+        y[i] = py;
+        heading[i] = h;
+        curvature[i] = c;
+    }
+    speedLimit(v_max, lat_acc);
+    return true;
+}
+
+// curvature limit, then acceleration and braking around the loop from the slowest point
+void TrackTable::speedLimit(float v_max, float lat_acc)
+{
+    size_t count = v.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        float k = std::fabs(curvature[i]);
+        v[i] = (k * v_max * v_max <= lat_acc) ? v_max : std::sqrt(lat_acc / k);
+    }
+    size_t slowest = std::min_element(v.begin(), v.end()) - v.begin();
+    for (size_t n = 1; n < count; n++)
+    {
+        size_t i = (slowest + n) % count, prev = (i + count - 1) % count;
+        v[i] = std::min(v[i], std::sqrt(v[prev] * v[prev] + 2 * (float)MAX_ACC * (float)step));
+    }
+    for (size_t n = 1; n < count; n++)
+    {
+        size_t i = (slowest + count - n) % count, next = (i + 1) % count;
+        v[i] = std::min(v[i], std::sqrt(v[next] * v[next] - 2 * (float)MAX_DECEL * (float)step));
+    }
+}
+
+double TrackTable::wrap(double s) const
+{
+    s = std::fmod(s, lap_length);
+    return (s < 0) ? s + lap_length : s;
+}
+
+void TrackTable::at(double s, Waypoint &point) const
+{
+    double f = wrap(s) / step;
+    size_t i = std::min((size_t)f, x.size() - 1);
+    size_t j = (i + 1) % x.size();
+    f -= i;
+    point.x = x[i] + f * (x[j] - x[i]);
+    point.y = y[i] + f * (y[j] - y[i]);
+    point.velocity = v[i] + f * (v[j] - v[i]);
+    point.angle = geometry::wrapAngle(heading[i] + f * geometry::wrapAngle(heading[j] - heading[i]));
+    double c = curvature[i] + f * (curvature[j] - curvature[i]);
+    point.radius = (c != 0) ? 1 / c : INFINITY;
+}
+
+double TrackTable::dist2(size_t i, double px, double py) const
+{
+    return geometry::dist2<double>(x[i], y[i], px, py);
+}
+
+double TrackTable::project(double px, double py, double s_hint) const
+{
+    size_t count = x.size();
+    if (count == 0)
+        return 0;
+
+    // nearest sample: downhill from the hint, the car moves a few samples per call
+    size_t i = 0;
+    double d = dist2(0, px, py);
+    if (s_hint < 0)
+    {
+        for (size_t k = 1; k < count; k++)
+        {
+            double dk = dist2(k, px, py);
+            if (dk < d)
+            {
+                d = dk;
+                i = k;
+            }
+        }
+    }
+    else
+    {
+        i = std::min((size_t)(wrap(s_hint) / step), count - 1);
+        d = dist2(i, px, py);
+        bool moved = false;
+        for (size_t n = 0; n < count; n++)
+        {
+            size_t next = (i + 1) % count;
+            double d_next = dist2(next, px, py);
+            if (d_next > d)
+                break;
+            i = next;
+            d = d_next;
+            moved = true;
+        }
+        for (size_t n = 0; !moved && n < count; n++)
+        {
+            size_t prev = (i + count - 1) % count;
+            double d_prev = dist2(prev, px, py);
+            if (d_prev >= d)
+                break;
+            i = prev;
+            d = d_prev;
+        }
+    }
+
+    // then onto the chords before and after it
+    double s = i * step;
+    for (size_t a: {(i + count - 1) % count, i})
+    {
+        size_t b = (a + 1) % count;
+        double ex = x[b] - x[a], ey = y[b] - y[a];
+        double len2 = ex * ex + ey * ey;
+        if (len2 <= 0)
+            continue;
+        double u = std::min(1.0, std::max(0.0, ((px - x[a]) * ex + (py - y[a]) * ey) / len2));
+        double du = geometry::dist2<double>(x[a] + u * ex, y[a] + u * ey, px, py);
+        if (du < d)
+        {
+            d = du;
+            s = (a + u) * step;
+        }
+    }
+    return wrap(s);
+}
@@ -0,0 +1,62 @@
+/**
+ * This is the table of the closed track, used by the follower once the planner closed the lap
+ * the centre line is fitted once with a closed (periodic) spline (PathSpline::fitClosed) and sampled every TABLE_STEP
+ * metres of arc length s: position, heading, curvature and speed limit
+ * the speed limit is the velocity profile of a lap that never ends: curvature limit, then the acceleration and braking
+ * passes around the loop (starting at the slowest point, so one pass each way is enough)
+ * every query takes s modulo the lap length, a lookup is an index and a linear interpolation,
+ * projecting the car searches only a few samples around the last result
+ * build() is slow (~ms) and runs on a background thread (see FollowerCore::closeLap), the table is read-only after it
+ *
+ * usage:   TrackTable table;
+ *          table.build(points.data(), points.size(), v_max, lat_acc);
+ *          s = table.project(x, y, s);  table.at(s + lookahead, goal);
+**/
+
+#ifndef SRC_TRACK_TABLE_H
+#define SRC_TRACK_TABLE_H
+
+#include <cmath>
+#include <vector>
+#include <cstddef>
+#include "waypoint.h"
+#include "path_spline.h"
+
+#define TABLE_STEP 0.1              // arc length between table samples (m), rounded so a lap is a whole number of them
+#define TABLE_SUBSTEPS 20           // spline samples per path point to measure the arc length
+
+class TrackTable
+{
+public:
+    // fits the closed spline through points[0..n-1] (the last point joins the first) and fills the tables
+    // false if there are less than 3 points
+    bool build(const Waypoint *points, size_t n, float v_max, float lat_acc);
+
+    double length() const { return lap_length; }
+    size_t size() const { return x.size(); }
+    double wrap(double s) const;        // s into [0, length)
+
+    // point at arc length s (any s, wraps around): x, y, velocity (speed limit), angle (heading, rad), radius
+    void at(double s, Waypoint &point) const;
+
+    // arc length of the point of the track nearest to (x, y), searching around s_hint (whole lap if s_hint < 0)
+    double project(double x, double y, double s_hint) const;
+
+private:
+    PathSpline spline;
+    double lap_length = 0;
+    double step = TABLE_STEP;           // lap_length / size(), the nearest to TABLE_STEP that divides the lap
+    // one entry per TABLE_STEP of arc length
+    std::vector<float> x, y;
+    std::vector<float> heading;         // rad
+    std::vector<float> curvature;       // 1/radius, > 0 for a left turn
+    std::vector<float> v;               // speed limit (m/s)
+
+    // (temporary vars) spline samples while building: parameter t and arc length
+    std::vector<double> sub_t, sub_s;
+
+    void speedLimit(float v_max, float lat_acc);
+    double dist2(size_t i, double px, double py) const;
+};
+
+#endif // SRC_TRACK_TABLE_H
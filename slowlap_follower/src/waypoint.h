@@ -0,0 +1,40 @@
+/**
+ * This is the Waypoint struct of the follower
+ * path points from the planner and splined points are stored as waypoints
+ * (not the planner's PathPoint, so the planner and follower cores can be linked together, see slowlap_replay)
+*/
+
+#ifndef SRC_WAYPOINT_H
+#define SRC_WAYPOINT_H
+
+struct Waypoint
+{
+    Waypoint();
+    Waypoint(float, float); 
+    float x;			// x coordinate on map
+    float y;			// y coordinate on map
+    float radius = 0;               // signed radius of the path (m), > 0 for a left turn, infinite on a straight
+    float velocity = 0; 
+    float angle = 0;                // heading of the path (rad)
+    bool passedBy = false;
+    void updatePoint(float, float);
+    void updatePoint(Waypoint);
+};
+
+inline Waypoint::Waypoint() {}
+inline Waypoint::Waypoint(float X, float Y)
+	: x(X), y(Y) {}
+inline void Waypoint::updatePoint(float xx,float yy)
+{
+    this->x = xx;
+    this->y = yy;
+}
+inline void Waypoint::updatePoint(Waypoint p)
+{
+    this->x = p.x;
+    this->y = p.y;
+}
+
+
+
+#endif // SRC_WAYPOINT_H
@@ -0,0 +1,101 @@
+/**
+ * checks the SIMD path sampling (sampleSegments) against the scalar one (sampleSegmentsScalar)
+ * positions and curvature are the same arithmetic in both, the heading of the SIMD versions is a polynomial atan2
+ **/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include "path_segments.h"
+
+#define POSITION_TOL 1e-9       // m
+#define CURVATURE_TOL 1e-9      // 1/m, relative to max(1, |curvature|)
+#define HEADING_TOL 1e-5        // rad
+
+struct Point
+{
+    double x, y;
+};
+
+// a wobbly loop of path points about 1 m apart, like the planner's centre line
+static std::vector<SplineSegment> randomChain(size_t n, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> noise(-0.3, 0.3);
+    std::vector<Point> points;
+    for (size_t i = 0; i < n; i++)
+    {
+        double a = i * 0.05;
+        points.push_back({20 * std::cos(a) + i * 0.3 + noise(rng), 20 * std::sin(a) + noise(rng)});
+    }
+    std::vector<SplineSegment> segments;
+    for (size_t i = 0; i + 1 < n; i++)
+        segments.push_back(catmullRomSegment(points.data(), n, i));
+    return segments;
+}
+
+static void compare(const std::vector<SplineSegment> &segments, double t_from, double step, size_t n)
+{
+    PathSamples simd, scalar;
+    sampleSegments(segments, t_from, step, n, simd);
+    sampleSegmentsScalar(segments, t_from, step, n, scalar);
+    ASSERT_EQ(simd.size(), scalar.size());
+    ASSERT_EQ(simd.size(), segments.empty() ? 0 : n);
+    for (size_t i = 0; i < simd.size(); i++)
+    {
+        EXPECT_NEAR(simd.x[i], scalar.x[i], POSITION_TOL) << "sample " << i << " of " << n;
+        EXPECT_NEAR(simd.y[i], scalar.y[i], POSITION_TOL) << "sample " << i << " of " << n;
+        EXPECT_NEAR(std::remainder(simd.heading[i] - scalar.heading[i], 2 * M_PI), 0, HEADING_TOL) << "sample " << i << " of " << n;
+        EXPECT_NEAR(simd.curvature[i], scalar.curvature[i], CURVATURE_TOL * std::max(1.0, std::fabs(scalar.curvature[i])))
+            << "sample " << i << " of " << n;
+    }
+}
+
+// counts that are not multiples of the lane count (scalar tail), samples across segment joins and past both ends
+TEST(PathSegments, SamplesMatchScalar)
+{
+    std::mt19937 rng(7);
+    for (size_t points: {2, 3, 5, 40, 150})
+    {
+        std::vector<SplineSegment> segments = randomChain(points, rng);
+        for (size_t n: std::initializer_list<size_t>{0, 1, 2, 3, 5, 7, 9, 10 * (points - 1) + 1, 10 * points + 13})
+        {
+            compare(segments, 0, 0.1, n);
+            compare(segments, -0.35, 0.1, n);
+            compare(segments, 0.5, 0.37, n);
+            compare(segments, 1.25, 0, n);
+        }
+    }
+}
+
+// the scalar reference itself: positions at the joins are the path points, curvature of a straight is 0
+TEST(PathSegments, ScalarSamplesOnStraight)
+{
+    std::vector<Point> points = {{0, 0}, {1, 1}, {2, 2}, {3, 3}};
+    std::vector<SplineSegment> segments;
+    for (size_t i = 0; i + 1 < points.size(); i++)
+        segments.push_back(catmullRomSegment(points.data(), points.size(), i));
+    PathSamples samples;
+    sampleSegmentsScalar(segments, 0, 0.25, 13, samples);
+    ASSERT_EQ(samples.size(), 13u);
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        EXPECT_NEAR(samples.x[i], samples.y[i], POSITION_TOL);
+        EXPECT_NEAR(samples.heading[i], M_PI / 4, HEADING_TOL);
+        EXPECT_NEAR(samples.curvature[i], 0, CURVATURE_TOL);
+    }
+    EXPECT_NEAR(samples.x[4], 1, POSITION_TOL);
+    EXPECT_NEAR(samples.x[12], 3, POSITION_TOL);
+}
+
+TEST(PathSegments, EmptyPath)
+{
+    PathSamples samples;
+    sampleSegments(std::vector<SplineSegment>(), 0, 0.1, 10, samples);
+    EXPECT_EQ(samples.size(), 0u);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
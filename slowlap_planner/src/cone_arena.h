@@ -0,0 +1,107 @@
+/**
+ * This is the cone storage of the planner
+ * cones are stored in fixed size chunks, a chunk is never reallocated so cones never move
+ * (a std::vector grows by moving everything to a new array), there is no reserve to guess
+ * inside a chunk the cones are a structure of arrays, split into hot and cold data:
+ * - hot: position, colour, passedBy/sorted flags and pair count, one contiguous array each,
+ *   these are what the grid, triangulation and path search read in their loops
+ * - cold: SLAM id and association stamp, only touched when SLAM cones are matched, in chunks of their own
+ * the rest of the planner refers to cones by ConeHandle (32 bit index), not by pointer,
+ * Cone is only the value type for cones going in (SLAM) and out (sorted cones)
+ **/
+
+#ifndef SRC_CONE_ARENA_H
+#define SRC_CONE_ARENA_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "cone.h"
+
+class ConeArena
+{
+public:
+    // copy cone into the arena, returns its handle
+    ConeHandle push_back(const Cone &cone)
+    {
+        if ((count & CHUNK_MASK) == 0) //last chunk is full (or there is none yet)
+        {
+            hot.emplace_back(new HotChunk());
+            cold.emplace_back(new ColdChunk());
+        }
+        uint32_t i = count & CHUNK_MASK;
+        HotChunk &h = *hot.back();
+        h.x[i] = cone.position.x;
+        h.y[i] = cone.position.y;
+        h.colour[i] = cone.colour;
+        h.flags[i] = 0;
+        h.pairs[i] = 0;
+        cold.back()->info[i] = {cone.id, 0};
+        return count++;
+    }
+
+    // hot data
+    float x(ConeHandle h) const { return hotChunk(h).x[h & CHUNK_MASK]; }
+    float y(ConeHandle h) const { return hotChunk(h).y[h & CHUNK_MASK]; }
+    PathPoint position(ConeHandle h) const { return PathPoint(x(h), y(h)); }
+    void setPosition(ConeHandle h, const PathPoint &pos) { hotChunk(h).x[h & CHUNK_MASK] = pos.x; hotChunk(h).y[h & CHUNK_MASK] = pos.y; }
+    char colour(ConeHandle h) const { return hotChunk(h).colour[h & CHUNK_MASK]; }
+    bool passedBy(ConeHandle h) const { return flags(h) & PASSED_BY; }      // if passed by car, position is final
+    void setPassedBy(ConeHandle h) { flags(h) |= PASSED_BY; }
+    bool sorted(ConeHandle h) const { return flags(h) & SORTED; }           // if in left/right sorted cones
+    void setSorted(ConeHandle h) { flags(h) |= SORTED; }
+    int paired(ConeHandle h) const { return hotChunk(h).pairs[h & CHUNK_MASK]; }   // path points formed with this cone
+    void pair(ConeHandle h) { hotChunk(h).pairs[h & CHUNK_MASK]++; }
+    void unpair(ConeHandle h) { hotChunk(h).pairs[h & CHUNK_MASK]--; }
+
+    // cold data
+    int id(ConeHandle h) const { return info(h).id; }
+    void setId(ConeHandle h, int id) { info(h).id = id; }
+    unsigned int assocStamp(ConeHandle h) const { return info(h).assoc_stamp; }
+    void setAssocStamp(ConeHandle h, unsigned int stamp) { info(h).assoc_stamp = stamp; }
+
+    // copy of a cone, for the output
+    Cone get(ConeHandle h) const { return Cone(x(h), y(h), colour(h), id(h)); }
+
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    static const uint32_t CHUNK_BITS = 8;                   // 256 cones per chunk
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+    static const uint8_t PASSED_BY = 1;
+    static const uint8_t SORTED = 2;
+
+    struct ConeInfo
+    {
+        int id;                         // SLAM id
+        unsigned int assoc_stamp;       // planner update in which this cone was last matched to a SLAM cone
+    };
+
+    struct HotChunk
+    {
+        float x[CHUNK_SIZE], y[CHUNK_SIZE];
+        char colour[CHUNK_SIZE];
+        uint8_t flags[CHUNK_SIZE];      // PASSED_BY | SORTED
+        int16_t pairs[CHUNK_SIZE];
+    };
+
+    struct ColdChunk
+    {
+        ConeInfo info[CHUNK_SIZE];
+    };
+
+    std::vector<std::unique_ptr<HotChunk>> hot;     // chunk k holds cones k*CHUNK_SIZE.., allocated once, never moved
+    std::vector<std::unique_ptr<ColdChunk>> cold;   // same cones as hot
+    uint32_t count = 0;                             // number of cones stored
+
+    HotChunk& hotChunk(ConeHandle h) { return *hot[h >> CHUNK_BITS]; }
+    const HotChunk& hotChunk(ConeHandle h) const { return *hot[h >> CHUNK_BITS]; }
+    uint8_t& flags(ConeHandle h) { return hotChunk(h).flags[h & CHUNK_MASK]; }
+    uint8_t flags(ConeHandle h) const { return hotChunk(h).flags[h & CHUNK_MASK]; }
+    ConeInfo& info(ConeHandle h) { return cold[h >> CHUNK_BITS]->info[h & CHUNK_MASK]; }
+    const ConeInfo& info(ConeHandle h) const { return cold[h >> CHUNK_BITS]->info[h & CHUNK_MASK]; }
+};
+
+#endif // SRC_CONE_ARENA_H
@@ -0,0 +1,65 @@
+/**
+ * uniform grid spatial index for cones, see cone_grid.h
+ **/
+
+#include "cone_grid.h"
+#include <algorithm>
+
+ConeGrid::ConeGrid(const ConeArena &cones, float cell_size)
+    : cones(cones), cell_size(cell_size), inv_cell_size(1.0f / cell_size) {}
+
+void ConeGrid::insert(ConeHandle cone)
+{
+    cells[key(cellIndex(cones.x(cone)), cellIndex(cones.y(cone)))].push_back(cone);
+    count++;
+}
+
+void ConeGrid::move(ConeHandle cone, const PathPoint &old_pos)
+{
+    int64_t old_key = key(cellIndex(old_pos.x), cellIndex(old_pos.y));
+    int64_t new_key = key(cellIndex(cones.x(cone)), cellIndex(cones.y(cone)));
+    if (old_key == new_key) //still in the same cell, nothing to do
+        return;
+
+    auto it = cells.find(old_key);
+    if (it != cells.end())
+    {
+        std::vector<ConeHandle> &c = it->second;
+        auto found = std::find(c.begin(), c.end(), cone);
+        if (found != c.end())
+        {
+            *found = c.back(); //order inside a cell does not matter
+            c.pop_back();
+        }
+    }
+    cells[new_key].push_back(cone);
+}
+
+void ConeGrid::remove(ConeHandle cone)
+{
+    auto it = cells.find(key(cellIndex(cones.x(cone)), cellIndex(cones.y(cone))));
+    if (it == cells.end())
+        return;
+    std::vector<ConeHandle> &c = it->second;
+    auto found = std::find(c.begin(), c.end(), cone);
+    if (found != c.end())
+    {
+        *found = c.back();
+        c.pop_back();
+        count--;
+    }
+}
+
+void ConeGrid::clear()
+{
+    cells.clear();
+    count = 0;
+}
+
+const std::vector<ConeHandle>* ConeGrid::cell(int cx, int cy) const
+{
+    auto it = cells.find(key(cx, cy));
+    if (it == cells.end() || it->second.empty())
+        return NULL;
+    return &it->second;
+}
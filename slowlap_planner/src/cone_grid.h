@@ -0,0 +1,124 @@
+/**
+ * This is the uniform grid spatial index for cones
+ * cones are bucketed into square cells (TRACKWIDTH sized), so a nearest or radius query
+ * only looks at the few cells around the query point instead of the whole cone vector
+ * the grid does not own the cones, it only keeps handles into the planner's ConeArena
+ **/
+
+#ifndef SRC_CONE_GRID_H
+#define SRC_CONE_GRID_H
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "cone_arena.h"
+
+class ConeGrid
+{
+public:
+    ConeGrid(const ConeArena&, float);              // constructor, takes the cone storage and the cell size
+    void insert(ConeHandle);                        // add cone at its current position
+    void move(ConeHandle, const PathPoint&);        // re-bucket a cone, call after its position changed (arg is the old position)
+    void remove(ConeHandle);                        // remove cone from the grid
+    void clear();
+    size_t size() const { return count; }
+
+    // nearest cone to pos within max_dist that satisfies pred(ConeHandle), NO_CONE if there is none
+    template <typename Pred>
+    ConeHandle nearest(const PathPoint &pos, float max_dist, Pred pred) const;
+
+    // all cones within r of pos that satisfy pred, appended to out
+    template <typename Pred>
+    void radius(const PathPoint &pos, float r, std::vector<ConeHandle> &out, Pred pred) const;
+
+private:
+    const ConeArena &cones;
+    float cell_size;
+    float inv_cell_size;
+    size_t count = 0;
+    std::unordered_map<int64_t, std::vector<ConeHandle>> cells;   // cell key -> cones in that cell
+
+    int cellIndex(float v) const { return (int)std::floor(v * inv_cell_size); }
+    static int64_t key(int cx, int cy) { return (int64_t)(((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy); }
+    const std::vector<ConeHandle>* cell(int cx, int cy) const;
+};
+
+// rings of cells are searched outwards from the query cell,
+// a cone in ring r+1 is at least r*cell_size away so we can stop once the best is closer than that
+template <typename Pred>
+ConeHandle ConeGrid::nearest(const PathPoint &pos, float max_dist, Pred pred) const
+{
+    ConeHandle closest = NO_CONE;
+    float min_dist2 = max_dist * max_dist;
+    int cx = cellIndex(pos.x);
+    int cy = cellIndex(pos.y);
+    int max_ring = (int)std::ceil(max_dist * inv_cell_size);
+
+    auto check = [&](int i, int j)
+    {
+        const std::vector<ConeHandle> *c = cell(i, j);
+        if (c == NULL)
+            return;
+        for (auto h: *c)
+        {
+            float dx = cones.x(h) - pos.x;
+            float dy = cones.y(h) - pos.y;
+            float d2 = dx*dx + dy*dy;
+            if (d2 <= min_dist2 && pred(h))
+            {
+                min_dist2 = d2;
+                closest = h;
+            }
+        }
+    };
+
+    for (int r = 0; r <= max_ring; r++)
+    {
+        if (r == 0)
+            check(cx, cy);
+        else
+        {
+            for (int i = -r; i <= r; i++)
+            {
+                check(cx + i, cy - r);
+                check(cx + i, cy + r);
+            }
+            for (int j = -r + 1; j < r; j++)
+            {
+                check(cx - r, cy + j);
+                check(cx + r, cy + j);
+            }
+        }
+        float ring_dist = r * cell_size;
+        if (closest != NO_CONE && min_dist2 <= ring_dist * ring_dist)
+            break;
+    }
+    return closest;
+}
+
+template <typename Pred>
+void ConeGrid::radius(const PathPoint &pos, float r, std::vector<ConeHandle> &out, Pred pred) const
+{
+    float r2 = r * r;
+    int x0 = cellIndex(pos.x - r), x1 = cellIndex(pos.x + r);
+    int y0 = cellIndex(pos.y - r), y1 = cellIndex(pos.y + r);
+    for (int i = x0; i <= x1; i++)
+    {
+        for (int j = y0; j <= y1; j++)
+        {
+            const std::vector<ConeHandle> *c = cell(i, j);
+            if (c == NULL)
+                continue;
+            for (auto h: *c)
+            {
+                float dx = cones.x(h) - pos.x;
+                float dy = cones.y(h) - pos.y;
+                if ((dx*dx + dy*dy) <= r2 && pred(h))
+                    out.push_back(h);
+            }
+        }
+    }
+}
+
+#endif // SRC_CONE_GRID_H
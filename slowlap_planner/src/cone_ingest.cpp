@@ -0,0 +1,106 @@
+/**
+ * cone ingestion stage, see cone_ingest.h
+ * decode() is called for every SLAM message, diff() when the planner is about to update,
+ * so if several messages arrive between planner updates only the latest one is diffed
+ **/
+
+#include "cone_ingest.h"
+#include <slowlap_common/log.h>
+#include <cmath>
+
+void ConeDelta::clear()
+{
+    added.clear();
+    moved.clear();
+    removed.clear();
+}
+
+// SLAM gives "BLUE", "YELLOW", "ORANGE", "BIG" (big orange) or "na",
+// first two chars are enough to tell them apart
+ConeColour ConeIngest::decodeColour(const std::string &colour)
+{
+    if (colour.size() < 3)
+        return NO_COLOUR;
+    switch (colour[0])
+    {
+        case 'B': return (colour[1] == 'L') ? BLUE : ORANGE;
+        case 'Y': return YELLOW;
+        case 'O': return ORANGE;
+        default: return NO_COLOUR;
+    }
+}
+
+// decode latest cone message, replaces the previously decoded one
+// a message whose x, y and colour lists differ in length is dropped (the previous one stays)
+void ConeIngest::decode(const std::vector<float> &x, const std::vector<float> &y, const std::vector<std::string> &colour)
+{
+    if (x.size() != colour.size() || y.size() != colour.size())
+    {
+        LOG_WARN("[PLANNER] cone msg dropped, {} x, {} y and {} colours", x.size(), y.size(), colour.size());
+        return;
+    }
+    cur_x.assign(x.begin(), x.end());
+    cur_y.assign(y.begin(), y.end());
+    cur_colour.resize(colour.size());
+    for (size_t i = 0; i < colour.size(); i++)
+    {
+        cur_colour[i] = decodeColour(colour[i]);
+        if (cur_colour[i] == NO_COLOUR && (i >= prev_colour.size() || prev_colour[i] != NO_COLOUR))
+            LOG_WARN("[PLANNER] '{}' cone colour passed, skipping", colour[i]);
+    }
+    fresh = true;
+}
+
+// compare latest decoded message to the cones last given to the planner
+// the latest message then becomes the reference for the next diff
+void ConeIngest::diff(ConeDelta &delta)
+{
+    delta.clear();
+    if (!fresh) //nothing new since last diff
+        return;
+    int n = cur_colour.size();
+    int n_prev = prev_colour.size();
+
+    for (int i = 0; i < n; i++)
+    {
+        char col = cur_colour[i];
+        char prev_col = (i < n_prev) ? prev_colour[i] : NO_COLOUR;
+
+        if (col != prev_col && prev_col != NO_COLOUR) //colour changed, so this id is a different cone now
+            delta.removed.push_back(i);
+
+        if (col == NO_COLOUR)
+            continue;
+        if (col != prev_col)
+            delta.added.emplace_back(cur_x[i], cur_y[i], col, i);
+        else if (std::fabs(cur_x[i] - prev_x[i]) > MOVE_EPS || std::fabs(cur_y[i] - prev_y[i]) > MOVE_EPS)
+            delta.moved.emplace_back(cur_x[i], cur_y[i], col, i);
+    }
+
+    for (int i = n; i < n_prev; i++) //cones no longer given by SLAM
+    {
+        if (prev_colour[i] != NO_COLOUR)
+            delta.removed.push_back(i);
+    }
+
+    prev_x.swap(cur_x);
+    prev_y.swap(cur_y);
+    prev_colour.swap(cur_colour);
+    fresh = false;
+}
+
+// all cones of the latest message, used to initialise the planner
+// the latest message also becomes the reference for the next diff
+void ConeIngest::takeSnapshot(std::vector<Cone> &cones)
+{
+    cones.clear();
+    for (size_t i = 0; i < cur_colour.size(); i++)
+    {
+        if (cur_colour[i] != NO_COLOUR)
+            cones.emplace_back(cur_x[i], cur_y[i], cur_colour[i], i);
+    }
+    prev_x = cur_x;
+    prev_y = cur_y;
+    prev_colour = cur_colour;
+    fresh = false;
+}
@@ -0,0 +1,52 @@
+/**
+ * This is the cone ingestion stage between SLAM and the planner
+ * cone messages are decoded once (colour strings -> ConeColour), then diffed against
+ * the cones the planner already has, so only added, moved or removed cones are passed on
+ * cones are identified by their index in the SLAM message (same as the cone id)
+ **/
+
+#ifndef SRC_CONE_INGEST_H
+#define SRC_CONE_INGEST_H
+
+#include <vector>
+#include <string>
+#include "cone.h"
+
+#define MOVE_EPS 0.01           // a SLAM cone has to move more than this to count as moved
+
+// cone colours, the values are the chars used in Cone::colour
+enum ConeColour : char
+{
+    BLUE = 'b',         // left
+    YELLOW = 'y',       // right
+    ORANGE = 'r',       // timing cones
+    NO_COLOUR = 'n'     // unknown ("na"), not used
+};
+
+// changes since the last cones given to the planner
+struct ConeDelta
+{
+    std::vector<Cone> added;        // cones not seen before
+    std::vector<Cone> moved;        // cones with a new position
+    std::vector<int> removed;       // ids of cones SLAM no longer gives
+    bool empty() const { return added.empty() && moved.empty() && removed.empty(); }
+    void clear();
+};
+
+class ConeIngest
+{
+public:
+    void decode(const std::vector<float>&, const std::vector<float>&, const std::vector<std::string>&);
+    void diff(ConeDelta&);
+    void takeSnapshot(std::vector<Cone>&);
+    static ConeColour decodeColour(const std::string&);
+
+private:
+    std::vector<float> cur_x, cur_y;        // latest decoded message
+    std::vector<char> cur_colour;
+    std::vector<float> prev_x, prev_y;      // cones last given to the planner
+    std::vector<char> prev_colour;
+    bool fresh = false;                     // if a message was decoded since the last diff
+};
+
+#endif // SRC_CONE_INGEST_H
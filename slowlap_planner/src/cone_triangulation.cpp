@@ -0,0 +1,334 @@
+/**
+ * incremental Delaunay triangulation of the cones, see cone_triangulation.h
+ * orientation tests are exact for float cone positions (products of float differences fit in a double)
+ **/
+
+#include "cone_triangulation.h"
+#include <cmath>
+
+#define SUPER_SIZE 1e4      // the super triangle encloses +-SUPER_SIZE metres around the origin
+
+const uint32_t ConeTriangulation::NONE;
+const uint32_t ConeTriangulation::SUPER_VERTICES;
+
+ConeTriangulation::ConeTriangulation(const ConeArena &cones)
+    : cones(cones)
+{
+    init();
+}
+
+// the super triangle only, no cones
+void ConeTriangulation::init()
+{
+    vertices.clear();
+    triangles.clear();
+    vertices.push_back({-3 * SUPER_SIZE, -3 * SUPER_SIZE, NO_CONE, 0});
+    vertices.push_back({3 * SUPER_SIZE, 0, NO_CONE, 0});
+    vertices.push_back({0, 3 * SUPER_SIZE, NO_CONE, 0});
+    triangles.push_back({{0, 1, 2}, {NONE, NONE, NONE}});
+    last_tri = 0;
+}
+
+void ConeTriangulation::clear()
+{
+    init();
+    cone_vertex.clear();
+}
+
+void ConeTriangulation::insert(ConeHandle cone)
+{
+    if (cone >= cone_vertex.size())
+        cone_vertex.resize(cone + 1, NONE);
+    uint32_t v = vertices.size();
+    vertices.push_back({cones.x(cone), cones.y(cone), cone, NONE});
+    cone_vertex[cone] = v;
+    insertVertex(v);
+}
+
+// the cone is flipped back into place if it stayed inside the polygon of its neighbours,
+// otherwise (or if it was not inserted before) the triangulation is rebuilt
+void ConeTriangulation::move(ConeHandle cone)
+{
+    uint32_t v = vertexOf(cone);
+    if (v == NONE)
+        return;
+    Vertex &vert = vertices[v];
+    vert.x = cones.x(cone);
+    vert.y = cones.y(cone);
+    if (vert.tri == NONE)
+    {
+        rebuild();
+        return;
+    }
+
+    // every triangle around the cone must still be counter-clockwise
+    flip_stack.clear();
+    uint32_t start = vert.tri;
+    uint32_t t = start;
+    do
+    {
+        const Triangle &tri = triangles[t];
+        int k = indexOf(tri, v);
+        uint32_t a = tri.v[(k + 1) % 3], b = tri.v[(k + 2) % 3];
+        if (orient(a, b, vert.x, vert.y) <= 0)
+        {
+            rebuild();
+            return;
+        }
+        for (int i = 0; i < 3; i++)
+            flip_stack.emplace_back(t, i);
+        t = tri.n[(k + 2) % 3];
+    } while (t != start && t != NONE);
+    legalise();
+}
+
+// inserts all cones again, in the order they were first seen
+void ConeTriangulation::rebuild()
+{
+    std::vector<Vertex> old;
+    old.swap(vertices);
+    init();
+    for (uint32_t v = SUPER_VERTICES; v < old.size(); v++)
+    {
+        vertices.push_back({old[v].x, old[v].y, old[v].cone, NONE});
+        insertVertex(v);
+    }
+}
+
+// returns false if the position is already taken (the vertex stays out of the triangulation)
+bool ConeTriangulation::insertVertex(uint32_t v)
+{
+    double x = vertices[v].x, y = vertices[v].y;
+    uint32_t t = locate(x, y);
+    if (t == NONE)
+        return false;
+
+    const Triangle &tri = triangles[t];
+    for (int i = 0; i < 3; i++)
+    {
+        const Vertex &corner = vertices[tri.v[i]];
+        if (corner.x == x && corner.y == y)
+            return false;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (orient(tri.v[(i + 1) % 3], tri.v[(i + 2) % 3], x, y) == 0) // on an edge, a 3-way split would leave a flat triangle
+        {
+            splitEdge(t, i, v);
+            legalise();
+            return true;
+        }
+    }
+    splitTriangle(t, v);
+    legalise();
+    return true;
+}
+
+// visibility walk towards (x, y), falls back to checking every triangle if the walk does not get there
+uint32_t ConeTriangulation::locate(double x, double y)
+{
+    uint32_t t = (last_tri < triangles.size()) ? last_tri : 0;
+    int start = 0;
+    for (int step = 0; step < MAX_WALK; step++)
+    {
+        const Triangle &tri = triangles[t];
+        bool moved = false;
+        for (int k = 0; k < 3; k++)
+        {
+            int i = (start + k) % 3;
+            if (orient(tri.v[(i + 1) % 3], tri.v[(i + 2) % 3], x, y) < 0)
+            {
+                if (tri.n[i] == NONE)
+                    return NONE;    // outside the super triangle
+                t = tri.n[i];
+                moved = true;
+                break;
+            }
+        }
+        if (!moved)
+        {
+            last_tri = t;
+            return t;
+        }
+        start = (start + 1) % 3;    // varying the first edge keeps the walk from cycling
+    }
+
+    for (uint32_t i = 0; i < triangles.size(); i++)
+    {
+        const Triangle &tri = triangles[i];
+        if (orient(tri.v[1], tri.v[2], x, y) >= 0 && orient(tri.v[2], tri.v[0], x, y) >= 0 &&
+            orient(tri.v[0], tri.v[1], x, y) >= 0)
+        {
+            last_tri = i;
+            return i;
+        }
+    }
+    return NONE;
+}
+
+// v is inside triangle t (a, b, c): t becomes (v, b, c), plus (v, c, a) and (v, a, b)
+void ConeTriangulation::splitTriangle(uint32_t t, uint32_t v)
+{
+    Triangle old = triangles[t];
+    uint32_t a = old.v[0], b = old.v[1], c = old.v[2];
+    uint32_t t1 = triangles.size(), t2 = t1 + 1;
+
+    triangles[t] = {{v, b, c}, {old.n[0], t1, t2}};
+    triangles.push_back({{v, c, a}, {old.n[1], t2, t}});
+    triangles.push_back({{v, a, b}, {old.n[2], t, t1}});
+    replaceNeighbour(old.n[1], t, t1);
+    replaceNeighbour(old.n[2], t, t2);
+
+    vertices[v].tri = t;
+    vertices[a].tri = t1;
+    vertices[b].tri = t;
+    vertices[c].tri = t;
+    flip_stack.clear();
+    flip_stack.emplace_back(t, 0);
+    flip_stack.emplace_back(t1, 0);
+    flip_stack.emplace_back(t2, 0);
+}
+
+// v is on the edge of t opposite index i, both triangles of that edge are split in two
+void ConeTriangulation::splitEdge(uint32_t t, int i, uint32_t v)
+{
+    Triangle old_t = triangles[t];
+    uint32_t a = old_t.v[i], b = old_t.v[(i + 1) % 3], c = old_t.v[(i + 2) % 3];
+    uint32_t A = old_t.n[(i + 1) % 3];     // across c-a
+    uint32_t B = old_t.n[(i + 2) % 3];     // across a-b
+    uint32_t u = old_t.n[i];
+    if (u == NONE)  // edge of the super triangle, cannot happen for cones on a track
+    {
+        splitTriangle(t, v);
+        return;
+    }
+    Triangle old_u = triangles[u];
+    int j = 0;
+    while (old_u.n[j] != t)
+        j++;
+    uint32_t d = old_u.v[j];
+    uint32_t C = old_u.n[(j + 1) % 3];     // across b-d
+    uint32_t D = old_u.n[(j + 2) % 3];     // across d-c
+
+    uint32_t t2 = triangles.size(), u2 = t2 + 1;
+    triangles[t] = {{a, b, v}, {u2, t2, B}};
+    triangles[u] = {{d, c, v}, {t2, u2, D}};
+    triangles.push_back({{a, v, c}, {u, A, t}});
+    triangles.push_back({{d, v, b}, {t, C, u}});
+    replaceNeighbour(A, t, t2);
+    replaceNeighbour(C, u, u2);
+
+    vertices[v].tri = t;
+    vertices[a].tri = t;
+    vertices[b].tri = t;
+    vertices[c].tri = t2;
+    vertices[d].tri = u;
+    flip_stack.clear();
+    flip_stack.emplace_back(t, 2);
+    flip_stack.emplace_back(t2, 1);
+    flip_stack.emplace_back(u, 2);
+    flip_stack.emplace_back(u2, 1);
+}
+
+// Lawson flips: every edge on the stack that is not Delaunay is flipped, the edges around it are checked next
+void ConeTriangulation::legalise()
+{
+    size_t max_flips = 4 * triangles.size() + 100;     // guards against flip cycles from rounding on near cocircular cones
+    size_t flips = 0;
+    while (!flip_stack.empty() && flips < max_flips)
+    {
+        uint32_t t = flip_stack.back().first;
+        int i = flip_stack.back().second;
+        flip_stack.pop_back();
+
+        uint32_t u = triangles[t].n[i];
+        if (u == NONE)
+            continue;
+        const Triangle &other = triangles[u];
+        int j = 0;
+        while (j < 3 && other.n[j] != t)
+            j++;
+        if (j == 3 || !inCircle(triangles[t], other.v[j]))
+            continue;
+        const Triangle &tri = triangles[t];     // only convex quads can be flipped (rounding in inCircle)
+        uint32_t s = other.v[j];
+        if (orient(tri.v[i], tri.v[(i + 1) % 3], vertices[s].x, vertices[s].y) <= 0 ||
+            orient(s, tri.v[(i + 2) % 3], vertices[tri.v[i]].x, vertices[tri.v[i]].y) <= 0)
+            continue;
+
+        flip(t, i);
+        flips++;
+        flip_stack.emplace_back(t, 0);
+        flip_stack.emplace_back(t, 2);
+        flip_stack.emplace_back(u, 0);
+        flip_stack.emplace_back(u, 2);
+    }
+    flip_stack.clear();
+}
+
+// t (p, q, r) and its neighbour u (s, r, q) across q-r become (p, q, s) and (s, r, p)
+void ConeTriangulation::flip(uint32_t t, int i)
+{
+    Triangle old_t = triangles[t];
+    uint32_t u = old_t.n[i];
+    Triangle old_u = triangles[u];
+    int j = 0;
+    while (old_u.n[j] != t)
+        j++;
+
+    uint32_t p = old_t.v[i], q = old_t.v[(i + 1) % 3], r = old_t.v[(i + 2) % 3];
+    uint32_t s = old_u.v[j];
+    uint32_t A = old_t.n[(i + 1) % 3];     // across r-p
+    uint32_t B = old_t.n[(i + 2) % 3];     // across p-q
+    uint32_t C = old_u.n[(j + 1) % 3];     // across q-s
+    uint32_t D = old_u.n[(j + 2) % 3];     // across s-r
+
+    triangles[t] = {{p, q, s}, {C, u, B}};
+    triangles[u] = {{s, r, p}, {A, t, D}};
+    replaceNeighbour(C, u, t);
+    replaceNeighbour(A, t, u);
+
+    vertices[p].tri = t;
+    vertices[q].tri = t;
+    vertices[r].tri = u;
+    vertices[s].tri = t;
+}
+
+void ConeTriangulation::replaceNeighbour(uint32_t t, uint32_t old_n, uint32_t new_n)
+{
+    if (t == NONE)
+        return;
+    for (int i = 0; i < 3; i++)
+    {
+        if (triangles[t].n[i] == old_n)
+        {
+            triangles[t].n[i] = new_n;
+            return;
+        }
+    }
+}
+
+int ConeTriangulation::indexOf(const Triangle &tri, uint32_t v) const
+{
+    return (tri.v[0] == v) ? 0 : (tri.v[1] == v) ? 1 : 2;
+}
+
+// > 0 if (x, y) is left of a->b
+double ConeTriangulation::orient(uint32_t a, uint32_t b, double x, double y) const
+{
+    const Vertex &va = vertices[a], &vb = vertices[b];
+    return (vb.x - va.x) * (y - va.y) - (vb.y - va.y) * (x - va.x);
+}
+
+// true if vertex d is strictly inside the circumcircle of the (counter-clockwise) triangle
+bool ConeTriangulation::inCircle(const Triangle &tri, uint32_t d) const
+{
+    const Vertex &a = vertices[tri.v[0]], &b = vertices[tri.v[1]], &c = vertices[tri.v[2]], &p = vertices[d];
+    double adx = a.x - p.x, ady = a.y - p.y;
+    double bdx = b.x - p.x, bdy = b.y - p.y;
+    double cdx = c.x - p.x, cdy = c.y - p.y;
+    double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+               + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+               + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+    return det > 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * This is the incremental Delaunay triangulation of the blue and yellow cones
+ * cones are inserted as SLAM reports them (Bowyer-Watson style: split the triangle the cone falls in,
+ * then Lawson edge flips until every edge is Delaunay again), nothing is rebuilt per update
+ * a cone that moved is flipped back into place, only if it moved across a neighbour the whole
+ * triangulation is rebuilt (rare, cones move by centimetres once seen)
+ * on a track, the edges between a blue and a yellow cone cross the track, their midpoints are the
+ * path point candidates (see PathPlanner::searchPath)
+ * like the grid, the triangulation only keeps handles into the planner's ConeArena
+ **/
+
+#ifndef SRC_CONE_TRIANGULATION_H
+#define SRC_CONE_TRIANGULATION_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "cone_arena.h"
+
+class ConeTriangulation
+{
+public:
+    explicit ConeTriangulation(const ConeArena&);   // constructor, takes the cone storage
+    void insert(ConeHandle);                        // add cone at its current position
+    void move(ConeHandle);                          // call after the cone's position changed
+    void clear();
+    size_t size() const { return vertices.size() - SUPER_VERTICES; }
+    bool contains(ConeHandle cone) const { return vertexOf(cone) != NONE && vertices[vertexOf(cone)].tri != NONE; }
+
+    // calls f(ConeHandle) for every cone that shares an edge with cone
+    template <typename F>
+    void forEachNeighbour(ConeHandle cone, F f) const;
+
+private:
+    static const uint32_t NONE = 0xFFFFFFFF;
+    static const uint32_t SUPER_VERTICES = 3;      // corners of the triangle that encloses the track
+    static const int MAX_WALK = 10000;              // steps before the point location gives up walking
+
+    struct Vertex
+    {
+        double x, y;
+        ConeHandle cone;        // NO_CONE for the super triangle
+        uint32_t tri;           // one triangle that has this vertex, NONE if not inserted (duplicate position)
+    };
+
+    // counter-clockwise, n[i] is the triangle across the edge opposite v[i]
+    struct Triangle
+    {
+        uint32_t v[3];
+        uint32_t n[3];
+    };
+
+    const ConeArena &cones;
+    std::vector<Vertex> vertices;
+    std::vector<Triangle> triangles;
+    std::vector<uint32_t> cone_vertex;                      // cone handle -> vertex, NONE if not in the triangulation
+    std::vector<std::pair<uint32_t, int>> flip_stack;       // edges (triangle, opposite index) to check
+    uint32_t last_tri = 0;                                  // point location starts here, cones arrive close together
+
+    uint32_t vertexOf(ConeHandle cone) const { return cone < cone_vertex.size() ? cone_vertex[cone] : NONE; }
+    void init();
+    void rebuild();
+    bool insertVertex(uint32_t);
+    uint32_t locate(double, double);
+    void splitTriangle(uint32_t, uint32_t);
+    void splitEdge(uint32_t, int, uint32_t);
+    void legalise();
+    void flip(uint32_t, int);
+    void replaceNeighbour(uint32_t, uint32_t, uint32_t);
+    int indexOf(const Triangle&, uint32_t) const;
+    double orient(uint32_t, uint32_t, double, double) const;
+    bool inCircle(const Triangle&, uint32_t) const;
+};
+
+// walks around the cone through the triangles that share it
+template <typename F>
+void ConeTriangulation::forEachNeighbour(ConeHandle cone, F f) const
+{
+    uint32_t v = vertexOf(cone);
+    if (v == NONE || vertices[v].tri == NONE)
+        return;
+    uint32_t start = vertices[v].tri;
+    uint32_t t = start;
+    do
+    {
+        const Triangle &tri = triangles[t];
+        int k = indexOf(tri, v);
+        uint32_t next = tri.v[(k + 1) % 3];
+        if (next >= SUPER_VERTICES)
+            f(vertices[next].cone);
+        t = tri.n[(k + 2) % 3];
+    } while (t != start && t != NONE);
+}
+
+#endif // SRC_CONE_TRIANGULATION_H
@@ -0,0 +1,222 @@
+/**
+ * batched cost kernel of the path search, see edge_cost.h
+ * the instruction set is picked at compile time (-mavx2 / -march=native for AVX2, SSE2 is always there on x86-64)
+ * feasibility is tested on squared lengths, the same way in every version, so they only differ by the atan2 rounding
+ **/
+
+#include "edge_cost.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define RAD_TO_DEG 57.29577951f
+#define HALF_PI 1.57079633f
+#define PI 3.14159265f
+
+// minimax polynomial for atan on [0, 1], coefficients of a, a^3, ... a^11
+#define ATAN_C0 0.99997726f
+#define ATAN_C1 -0.33262347f
+#define ATAN_C2 0.19354346f
+#define ATAN_C3 -0.11643287f
+#define ATAN_C4 0.05265332f
+#define ATAN_C5 -0.01172120f
+
+void EdgeBatch::clear()
+{
+    lx.clear();
+    ly.clear();
+    rx.clear();
+    ry.clear();
+    left.clear();
+    right.clear();
+}
+
+void EdgeBatch::push(ConeHandle l, const PathPoint &l_pos, ConeHandle r, const PathPoint &r_pos)
+{
+    lx.push_back(l_pos.x);
+    ly.push_back(l_pos.y);
+    rx.push_back(r_pos.x);
+    ry.push_back(r_pos.y);
+    left.push_back(l);
+    right.push_back(r);
+}
+
+// edges from..size-1, one at a time
+static void scoreEdges(EdgeBatch &b, size_t from, float x, float y, float hx, float hy, const EdgeCostParams &p)
+{
+    float min_w2 = p.min_width * p.min_width, max_w2 = p.max_width * p.max_width;
+    float min_s2 = p.min_step * p.min_step, max_s2 = p.max_step * p.max_step;
+    for (size_t i = from; i < b.size(); i++)
+    {
+        float dx = b.rx[i] - b.lx[i];
+        float dy = b.ry[i] - b.ly[i];
+        float w2 = dx*dx + dy*dy;
+        float sx = (b.lx[i] + b.rx[i]) * 0.5f - x;
+        float sy = (b.ly[i] + b.ry[i]) * 0.5f - y;
+        float s2 = sx*sx + sy*sy;
+        float angle = std::atan2(hx*sy - hy*sx, hx*sx + hy*sy) * RAD_TO_DEG;
+        b.angle[i] = angle;
+        if (w2 < min_w2 || w2 > max_w2 || s2 < min_s2 || s2 > max_s2 || std::fabs(angle) > p.max_angle)
+        {
+            b.cost[i] = INFINITY;
+            continue;
+        }
+        float turn = angle / p.max_angle;
+        float width_error = (std::sqrt(w2) - p.track_width) / p.track_width;
+        b.cost[i] = turn*turn + width_error*width_error;
+    }
+}
+
+void edgeCostsScalar(EdgeBatch &batch, float x, float y, float hx, float hy, const EdgeCostParams &params)
+{
+    batch.cost.resize(batch.size());
+    batch.angle.resize(batch.size());
+    scoreEdges(batch, 0, x, y, hx, hy, params);
+}
+
+#if defined(__AVX2__)
+
+static inline __m256 atan2_avx(__m256 y, __m256 x)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(sign, x);
+    __m256 ay = _mm256_andnot_ps(sign, y);
+    __m256 hi = _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(1e-30f));
+    __m256 a = _mm256_div_ps(_mm256_min_ps(ax, ay), hi);
+    __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_set1_ps(ATAN_C5);
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C4));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C3));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C2));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C1));
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(ATAN_C0));
+    r = _mm256_mul_ps(r, a);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(PI), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_or_ps(r, _mm256_and_ps(sign, y));
+}
+
+void edgeCosts(EdgeBatch &b, float x, float y, float hx, float hy, const EdgeCostParams &p)
+{
+    size_t n = b.size();
+    b.cost.resize(n);
+    b.angle.resize(n);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 vx = _mm256_set1_ps(x), vy = _mm256_set1_ps(y);
+    const __m256 vhx = _mm256_set1_ps(hx), vhy = _mm256_set1_ps(hy);
+    const __m256 min_w2 = _mm256_set1_ps(p.min_width * p.min_width), max_w2 = _mm256_set1_ps(p.max_width * p.max_width);
+    const __m256 min_s2 = _mm256_set1_ps(p.min_step * p.min_step), max_s2 = _mm256_set1_ps(p.max_step * p.max_step);
+    const __m256 max_angle = _mm256_set1_ps(p.max_angle), inv_angle = _mm256_set1_ps(1 / p.max_angle);
+    const __m256 width = _mm256_set1_ps(p.track_width), inv_width = _mm256_set1_ps(1 / p.track_width);
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 lx = _mm256_loadu_ps(&b.lx[i]), ly = _mm256_loadu_ps(&b.ly[i]);
+        __m256 rx = _mm256_loadu_ps(&b.rx[i]), ry = _mm256_loadu_ps(&b.ry[i]);
+        __m256 dx = _mm256_sub_ps(rx, lx), dy = _mm256_sub_ps(ry, ly);
+        __m256 w2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 sx = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(lx, rx), half), vx);
+        __m256 sy = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(ly, ry), half), vy);
+        __m256 s2 = _mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy));
+        __m256 cross = _mm256_sub_ps(_mm256_mul_ps(vhx, sy), _mm256_mul_ps(vhy, sx));
+        __m256 dot = _mm256_add_ps(_mm256_mul_ps(vhx, sx), _mm256_mul_ps(vhy, sy));
+        __m256 angle = _mm256_mul_ps(atan2_avx(cross, dot), _mm256_set1_ps(RAD_TO_DEG));
+
+        __m256 ok = _mm256_and_ps(_mm256_cmp_ps(w2, min_w2, _CMP_GE_OQ), _mm256_cmp_ps(w2, max_w2, _CMP_LE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_and_ps(_mm256_cmp_ps(s2, min_s2, _CMP_GE_OQ), _mm256_cmp_ps(s2, max_s2, _CMP_LE_OQ)));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_and_ps(angle, abs_mask), max_angle, _CMP_LE_OQ));
+
+        __m256 turn = _mm256_mul_ps(angle, inv_angle);
+        __m256 width_error = _mm256_mul_ps(_mm256_sub_ps(_mm256_sqrt_ps(w2), width), inv_width);
+        __m256 cost = _mm256_add_ps(_mm256_mul_ps(turn, turn), _mm256_mul_ps(width_error, width_error));
+        _mm256_storeu_ps(&b.cost[i], _mm256_blendv_ps(inf, cost, ok));
+        _mm256_storeu_ps(&b.angle[i], angle);
+    }
+    scoreEdges(b, i, x, y, hx, hy, p);
+}
+
+#elif defined(__SSE2__)
+
+// a where mask is set, else b (SSE2 has no blendv)
+static inline __m128 select_sse(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 atan2_sse(__m128 y, __m128 x)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 ax = _mm_andnot_ps(sign, x);
+    __m128 ay = _mm_andnot_ps(sign, y);
+    __m128 hi = _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(1e-30f));
+    __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), hi);
+    __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_set1_ps(ATAN_C5);
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C4));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C3));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C2));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C1));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(ATAN_C0));
+    r = _mm_mul_ps(r, a);
+    r = select_sse(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(HALF_PI), r), r);
+    r = select_sse(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), r), r);
+    return _mm_or_ps(r, _mm_and_ps(sign, y));
+}
+
+void edgeCosts(EdgeBatch &b, float x, float y, float hx, float hy, const EdgeCostParams &p)
+{
+    size_t n = b.size();
+    b.cost.resize(n);
+    b.angle.resize(n);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 vx = _mm_set1_ps(x), vy = _mm_set1_ps(y);
+    const __m128 vhx = _mm_set1_ps(hx), vhy = _mm_set1_ps(hy);
+    const __m128 min_w2 = _mm_set1_ps(p.min_width * p.min_width), max_w2 = _mm_set1_ps(p.max_width * p.max_width);
+    const __m128 min_s2 = _mm_set1_ps(p.min_step * p.min_step), max_s2 = _mm_set1_ps(p.max_step * p.max_step);
+    const __m128 max_angle = _mm_set1_ps(p.max_angle), inv_angle = _mm_set1_ps(1 / p.max_angle);
+    const __m128 width = _mm_set1_ps(p.track_width), inv_width = _mm_set1_ps(1 / p.track_width);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 inf = _mm_set1_ps(INFINITY);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 lx = _mm_loadu_ps(&b.lx[i]), ly = _mm_loadu_ps(&b.ly[i]);
+        __m128 rx = _mm_loadu_ps(&b.rx[i]), ry = _mm_loadu_ps(&b.ry[i]);
+        __m128 dx = _mm_sub_ps(rx, lx), dy = _mm_sub_ps(ry, ly);
+        __m128 w2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 sx = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(lx, rx), half), vx);
+        __m128 sy = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(ly, ry), half), vy);
+        __m128 s2 = _mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy));
+        __m128 cross = _mm_sub_ps(_mm_mul_ps(vhx, sy), _mm_mul_ps(vhy, sx));
+        __m128 dot = _mm_add_ps(_mm_mul_ps(vhx, sx), _mm_mul_ps(vhy, sy));
+        __m128 angle = _mm_mul_ps(atan2_sse(cross, dot), _mm_set1_ps(RAD_TO_DEG));
+
+        __m128 ok = _mm_and_ps(_mm_cmpge_ps(w2, min_w2), _mm_cmple_ps(w2, max_w2));
+        ok = _mm_and_ps(ok, _mm_and_ps(_mm_cmpge_ps(s2, min_s2), _mm_cmple_ps(s2, max_s2)));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_and_ps(angle, abs_mask), max_angle));
+
+        __m128 turn = _mm_mul_ps(angle, inv_angle);
+        __m128 width_error = _mm_mul_ps(_mm_sub_ps(_mm_sqrt_ps(w2), width), inv_width);
+        __m128 cost = _mm_add_ps(_mm_mul_ps(turn, turn), _mm_mul_ps(width_error, width_error));
+        _mm_storeu_ps(&b.cost[i], select_sse(ok, cost, inf));
+        _mm_storeu_ps(&b.angle[i], angle);
+    }
+    scoreEdges(b, i, x, y, hx, hy, p);
+}
+
+#else
+
+void edgeCosts(EdgeBatch &batch, float x, float y, float hx, float hy, const EdgeCostParams &params)
+{
+    edgeCostsScalar(batch, x, y, hx, hy, params);
+}
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * This is the batched cost kernel of the path search
+ * every candidate next path point is the midpoint of a blue-yellow edge of the triangulation,
+ * the edges of one step are packed into an EdgeBatch (one array per coordinate) and
+ * edgeCosts() scores all of them at once: 8 edges per instruction with AVX2, 4 with SSE2, else one by one
+ * the SIMD versions use a polynomial atan2 (error < 0.001 deg), the scalar version std::atan2
+ **/
+
+#ifndef SRC_EDGE_COST_H
+#define SRC_EDGE_COST_H
+
+#include <vector>
+#include <cstddef>
+#include "cone_arena.h"
+
+// limits and weights of a path step, see PathPlanner::expandBeam
+struct EdgeCostParams
+{
+    float track_width;      // expected edge length, cost grows with the deviation from it
+    float min_width;        // edges outside [min_width, max_width] are infeasible
+    float max_width;
+    float min_step;         // distance from the current point to the midpoint
+    float max_step;
+    float max_angle;        // max turn in degrees, also the turn cost scale
+};
+
+// candidate edges of one search step, left is the blue cone, right the yellow one
+struct EdgeBatch
+{
+    std::vector<float> lx, ly, rx, ry;
+    std::vector<ConeHandle> left, right;
+    std::vector<float> cost, angle;         // outputs of edgeCosts()
+
+    void clear();
+    void push(ConeHandle, const PathPoint&, ConeHandle, const PathPoint&);
+    size_t size() const { return lx.size(); }
+};
+
+// fills batch.cost (INFINITY for infeasible edges) and batch.angle (turn in degrees, left is positive)
+// for a path at (x, y) heading along (hx, hy), the heading does not have to be normalised but must not be (0, 0)
+void edgeCosts(EdgeBatch &batch, float x, float y, float hx, float hy, const EdgeCostParams &params);
+
+// same, one edge at a time, for checking the SIMD versions
+void edgeCostsScalar(EdgeBatch &batch, float x, float y, float hx, float hy, const EdgeCostParams &params);
+
+#endif // SRC_EDGE_COST_H
@@ -4,9 +4,11 @@
 #include "node.h"
 
 bool constant_v = false;
-float v_max = 5.0;
-float v_const = 3.0;
-float max_f_gain = 3.0;
+float v_max = DEFAULT_V_MAX;
+float v_const = DEFAULT_V_CONST;
+float max_f_gain = DEFAULT_MAX_F_GAIN;
+std::string map_file = "slowlap_track.map";   // relative to the node's working directory (~/.ros)
+bool load_map = false;
 
 void checkParams(ros::NodeHandle &n)
 {
@@ -26,6 +28,14 @@ void checkParams(ros::NodeHandle &n)
     {
 	ROS_INFO_STREAM("Planner: No 'max_f_gain' param found. Defaulting");
     }
+    if (!n.hasParam("map_file"))
+    {
+	ROS_INFO_STREAM("Planner: No 'map_file' param found. Defaulting");
+    }
+    if (!n.hasParam("load_map"))
+    {
+	ROS_INFO_STREAM("Planner: No 'load_map' param found. Defaulting");
+    }
 }
 
 int main(int argc, char **argv)
@@ -40,15 +50,13 @@ int main(int argc, char **argv)
 	n.getParam("v_max", v_max);
 	n.getParam("v_const", v_const);
 	n.getParam("max_f_gain", max_f_gain);
+	n.getParam("map_file", map_file);
+	n.getParam("load_map", load_map);
 
-	PlannerNode planner(n, constant_v, v_max, v_const, max_f_gain);
-
-	while (ros::ok())
-	{
-	    planner.spinThread();
-        if (planner.fastLapReady)
-            break;
-	}
+	PlannerNode planner(n, constant_v, v_max, v_const, max_f_gain, map_file, load_map);
+	ros::AsyncSpinner spinner(1);	// callbacks, planning and publishing have their own threads (see node.h)
+	spinner.start();
+	ros::waitForShutdown();
 
     }
     return 0;
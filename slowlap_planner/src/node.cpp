@@ -10,59 +10,70 @@
 #include "node.h"
 
 // constructor
-PlannerNode::PlannerNode(ros::NodeHandle n, bool const_velocity, float v_max, float v_const, float max_f_gain)
-    : nh(n), const_velocity(const_velocity), v_max(v_max), v_const(v_const), max_f_gain(max_f_gain)
+PlannerNode::PlannerNode(ros::NodeHandle n, bool const_velocity, float v_max, float v_const, float max_f_gain,
+                         const std::string &map_file, bool load_map, bool standalone)
+    : nh(n), viz(nh, FRAME), standalone(standalone), map_file(map_file), load_map(load_map)
 {
-    Path.reserve(300);
-    Left.reserve(200);
-    Right.reserve(200);
-    cones.reserve(500);
-    Markers.reserve(1000); 
+    config.const_velocity = const_velocity;
+    config.v_max = v_max;
+    config.v_const = v_const;
+    config.max_f_gain = max_f_gain;
+
+    for (int i = 0; i < 3; i++)
+    {
+        PlannerOutput &result = outputs.slot(i);
+        result.path.reserve(300);
+        result.left_cones.reserve(200);
+        result.right_cones.reserve(200);
+        result.markers.reserve(1000); 
+    }
+    input.cones.added.reserve(500);
     // sortMarks.reserve(100);
     
-    times.reserve(std::numeric_limits<uint16_t>::max());    // diagnostic stuff (MURauto20)
-    rtimes.reserve(std::numeric_limits<uint16_t>::max());   // diagnostic stuff (MURauto20)
-    
-    launchSubscribers();
+    last_plan_health = last_publish_health = Clock::now();
     launchPublishers();
-    waitForMsgs();
-    initialisePlanner();
-    now = ros::Time::now();
+    if (load_map)
+        loadTrackMap();     // the complete map is the first output, the publishing thread sends it straight away
+    planning_thread = std::thread(&PlannerNode::planningLoop, this);
+    publishing_thread = std::thread(&PlannerNode::publishingLoop, this);
+    launchSubscribers();
 }
 
-// initialises planner (path_planner.cpp), waits for cones to be received (especially orange cones)
-void PlannerNode::initialisePlanner()
+// stops the pipeline threads, the callbacks must already be stopped (see main.cpp)
+PlannerNode::~PlannerNode()
 {
-    if (cone_msg_received)
+    running = false;
     {
-        int countRed = 0;
-        for (auto &cn: cones)
-        {
-            if (cn.colour == 'r')
-                countRed++;
-        }
-        if (countRed>1)
-        {
-            this->planner = std::unique_ptr<PathPlanner>(new PathPlanner(car_x, car_y, cones, const_velocity, v_max, v_const, max_f_gain, Markers));
-            ROS_INFO_STREAM("[PLANNER] Planner initialized");
-            plannerInitialised = true;
-        }
-        else
-            std::cout<<"Timing cones (orange) not yet found"<<std::endl;
-
+        std::lock_guard<std::mutex> lock(wake_mutex);
     }
-    else
-        std::cout<<"No cones received yet"<<std::endl;
-
+    plan_wake.notify_all();
+    publish_wake.notify_all();
+    if (planning_thread.joinable())
+        planning_thread.join();
+    if (publishing_thread.joinable())
+        publishing_thread.join();
 }
 
-// spinOnce when msgs are received
-void PlannerNode::waitForMsgs()
+// initialises planner (path_planner.cpp), waits for cones to be received (especially orange cones)
+void PlannerNode::initialisePlanner()
 {
-    while (!cone_msg_received || !odom_msg_received && ros::ok()) 
+    ingest.takeSnapshot(input.cones.added);
+    input.car_x = car_x;
+    input.car_y = car_y;
+    int countRed = 0;
+    for (auto &cn: input.cones.added)
     {
-	ros::spinOnce();
+        if (cn.colour == 'r')
+            countRed++;
     }
+    if (countRed>1)
+    {
+        this->planner = std::unique_ptr<PathPlanner>(new PathPlanner(config, input));
+        ROS_INFO_STREAM("[PLANNER] Planner initialized");
+        plannerInitialised = true;
+    }
+    else
+        LOG_INFO("[PLANNER] Timing cones (orange) not yet found");
 }
 
 // standard ROS function. launch subscribers
@@ -70,8 +81,12 @@ int PlannerNode::launchSubscribers()
 {
     try
     {
-        sub_odom = nh.subscribe(MUR_ODOM_TOPIC, 1, &PlannerNode::odomCallback, this);
-        sub_cones = nh.subscribe(CONE_TOPIC, 1, &PlannerNode::coneCallback, this);
+        // cone and odometry msgs are paired by header stamp, the planner runs once per pair
+        sub_odom.subscribe(nh, MUR_ODOM_TOPIC, SYNC_QUEUE);
+        sub_cones.subscribe(nh, CONE_TOPIC, SYNC_QUEUE);
+        sync = std::unique_ptr<message_filters::Synchronizer<OdomConeSync>>(
+            new message_filters::Synchronizer<OdomConeSync>(OdomConeSync(SYNC_QUEUE), sub_odom, sub_cones));
+        sync->registerCallback(boost::bind(&PlannerNode::callback, this, _1, _2));
         sub_transition = nh.subscribe(FASTLAP_READY_TOPIC, 1, &PlannerNode::transitionCallback, this);
     }
     catch (const char *msg)
@@ -88,14 +103,15 @@ int PlannerNode::launchPublishers()
 {
     try
     {
-        pub_path = nh.advertise<mur_common::path_msg>(PATH_TOPIC, 1);
-        pub_path_viz = nh.advertise<nav_msgs::Path>(PATH_VIZ_TOPIC, 1);
-        pub_health = nh.advertise<mur_common::diagnostic_msg>(HEALTH_TOPIC, 1);
+        pub_path = nh.advertise<slowlap_common::path_delta_msg>(PATH_TOPIC, 10);   // deltas, a lost msg costs a resync
+        pub_health = nh.advertise<diagnostic_msgs::DiagnosticArray>(HEALTH_TOPIC, 1);
         pub_lcones = nh.advertise<mur_common::cone_msg>(SORTED_LCONES_TOPIC, 1);
         pub_rcones = nh.advertise<mur_common::cone_msg>(SORTED_RCONES_TOPIC, 1);
-        pub_pathCones = nh.advertise<visualization_msgs::MarkerArray>(PATH_CONES_TOPIC,1);
-        pub_map = nh.advertise<mur_common::map_msg>(FINISHED_MAP_TOPIC,1);
-        
+        pub_map = nh.advertise<mur_common::map_msg>(FINISHED_MAP_TOPIC,1,true);   // latched, it is only sent once
+        path_viz = viz.addPath(PATH_VIZ_TOPIC);
+        path_cones = viz.addMarkerArray(PATH_CONES_TOPIC, visualization_msgs::Marker::LINE_LIST, 0.15, 0.15, 0.35);
+        viz.start();
+
     }
     catch (const char *msg)
     {
@@ -109,270 +125,337 @@ int PlannerNode::launchPublishers()
 
 // these are the last steps when slow lap is finished mapping
 // transition to fast lap
-void PlannerNode::SlowLapFinished()
+void PlannerNode::SlowLapFinished(const PlannerOutput &out)
 {
+    if (slowLapDone)
+        return;
+    slowLapDone = true;
     ROS_INFO_STREAM("[PLANNER] SLOW LAP FINISHED!! [PLANNER] Publishing path points and cone positions...");
+    if (!mapLoaded)
+        saveTrackMap(out);
     
     // publish complete map:
-    mur_common::map_msg map;
+    mur_common::map_msg::Ptr map = boost::make_shared<mur_common::map_msg>();
     std::vector<float> ConeX,ConeY;
     //copy left cones
-    ConeX.reserve(Left.size());
-    ConeY.reserve(Left.size());
-    for (auto &cn:Left)
+    ConeX.reserve(out.left_cones.size());
+    ConeY.reserve(out.left_cones.size());
+    for (auto &cn:out.left_cones)
     {
         ConeX.push_back(cn.position.x);
         ConeY.push_back(cn.position.y);
     }
-    ConeX.push_back(Left.front().position.x);
-    ConeY.push_back(Left.front().position.y);
-    map.x_o = ConeX;
-    map.y_o = ConeY;
+    if (!out.left_cones.empty())
+    {
+        ConeX.push_back(out.left_cones.front().position.x);
+        ConeY.push_back(out.left_cones.front().position.y);
+    }
+    map->x_o = ConeX;
+    map->y_o = ConeY;
     ConeX.clear();
     ConeY.clear();
     //copy right cones
-    ConeX.reserve(Right.size());
-    ConeY.reserve(Right.size());
-    for (auto &cn:Right)
+    ConeX.reserve(out.right_cones.size());
+    ConeY.reserve(out.right_cones.size());
+    for (auto &cn:out.right_cones)
     {
         ConeX.push_back(cn.position.x);
         ConeY.push_back(cn.position.y);
     }
-    ConeX.push_back(Right.front().position.x);
-    ConeY.push_back(Right.front().position.y);
-    map.x_i = ConeX;
-    map.y_i = ConeY;
+    if (!out.right_cones.empty())
+    {
+        ConeX.push_back(out.right_cones.front().position.x);
+        ConeY.push_back(out.right_cones.front().position.y);
+    }
+    map->x_i = ConeX;
+    map->y_i = ConeY;
 
     //copy path points
-    for (auto &p:Path)
+    for (auto &p:out.path)
     {
-        map.x.push_back(p.x);
-        map.y.push_back(p.y);
+        map->x.push_back(p.x);
+        map->y.push_back(p.y);
     }
 
-    map.mapready = true;
-    map.frame_id = FRAME;
+    map->mapready = true;
+    map->frame_id = FRAME;
 
     pub_map.publish(map);
 }
 
-// shut down
-void PlannerNode::shut_down()
+// writes the complete map to map_file (publishing thread, once)
+void PlannerNode::saveTrackMap(const PlannerOutput &out)
 {
-    ROS_INFO_STREAM("[PLANNER] shutting down...");
-    clearTempVectors();
-    pushPath();
-    // pushPathViz();
-    pushMarkers();     
+    TrackMapData data;
+    for (auto &cn: out.left_cones)
+    {
+        data.left_x.push_back(cn.position.x);
+        data.left_y.push_back(cn.position.y);
+    }
+    for (auto &cn: out.right_cones)
+    {
+        data.right_x.push_back(cn.position.x);
+        data.right_y.push_back(cn.position.y);
+    }
+    for (auto &p: out.path)
+    {
+        data.centre_x.push_back(p.x);
+        data.centre_y.push_back(p.y);
+    }
+    if (writeTrackMap(map_file, data))
+        ROS_INFO_STREAM("[PLANNER] track map saved to " << map_file);
+    else
+        ROS_WARN_STREAM("[PLANNER] could not save the track map to " << map_file);
 }
 
-// void loop()
-void PlannerNode::spinThread()
+// maps map_file in and hands it to the publishing thread as a complete planner output (before the threads start)
+// the planning thread then only sends this output again for every SLAM msg, so a late follower still gets the path
+// returns false if there is no valid map, the track is then mapped as usual
+bool PlannerNode::loadTrackMap()
 {
-    clearTempVectors();
-    waitForMsgs();
-    if (plannerInitialised)
+    if (!saved_map.open(map_file))
     {
-        planner->update(cones, car_x, car_y, Path, Left, Right,Markers,plannerComplete);
-        if (plannerComplete)
-            SlowLapFinished();
-        
-        if(fastLapReady)
-            shut_down();
-        else
-        {
-            pushPath();
-            pushPathViz();
-            pushMarkers();
-        }        
+        ROS_INFO_STREAM("[PLANNER] no track map loaded from " << map_file << ": " << saved_map.error());
+        return false;
+    }
+    PlannerOutput &out = map_output;
+    for (uint32_t i = 0; i < saved_map.leftCount(); i++)
+        out.left_cones.emplace_back(saved_map.leftX()[i], saved_map.leftY()[i], 'b', i);
+    for (uint32_t i = 0; i < saved_map.rightCount(); i++)
+        out.right_cones.emplace_back(saved_map.rightX()[i], saved_map.rightY()[i], 'y', i);
+    for (uint32_t i = 0; i < saved_map.centreCount(); i++)
+        out.path.emplace_back(saved_map.centreX()[i], saved_map.centreY()[i]);
+    // the file has no velocities, the reference velocity is set as the planner would (see PathPlanner::updateVelocity)
+    if (config.const_velocity)
+    {
+        for (auto &p: out.path)
+            p.velocity = config.v_const;
     }
     else
-        initialisePlanner();
-        
-   
-    ros::Rate(HZ).sleep();
+    {
+        VelocityProfile profile(config.v_max, config.max_f_gain);
+        profile.update(out.path, 0);
+    }
+    out.complete = true;
+    outputs.back() = map_output;
+    outputs.publish();
+    mapLoaded = true;
+    float length = (saved_map.centreCount() > 0) ? saved_map.centreS()[saved_map.centreCount() - 1] : 0;
+    ROS_INFO_STREAM("[PLANNER] track map loaded from " << map_file << ", " << saved_map.centreCount()
+                    << " path points, " << length << " m");
+    return true;
 }
 
-// diagnostic stuff (MURauto20) not used in 2021
-void PlannerNode::pushHealth(ClockTP& s, ClockTP& e, ClockTP& rs, ClockTP& re)
+// shut down, publishes an empty path (publishing thread)
+void PlannerNode::shut_down()
 {
-    mur_common::diagnostic_msg h;
-    times.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(e - s).count());
-    rtimes.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(re - rs).count());
-    float mean = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
-    float rmean = std::accumulate(rtimes.begin(), rtimes.end(), 0.0) / rtimes.size();
-    h.compute_times = times;
-    h.full_compute_times = rtimes;
-    h.avg_times = mean;
-    h.full_avg_times = rmean;
-    pub_health.publish(h);
+    ROS_INFO_STREAM("[PLANNER] shutting down...");
+    PlannerOutput empty;
+    pushPath(empty);
+    // pushPathViz(empty);
+    pushMarkers(empty);
+    viz.flush();            // the viz thread may not run again before ROS shuts down
 }
 
-//clear temporary vectors, and reset some flags
-void PlannerNode::clearTempVectors()
+// matched odometry and cone msgs (from SLAM), runs on the spinner thread (nodelet manager thread as a nodelet)
+// only hands the msgs over to the planning thread, which wakes up straight away
+void PlannerNode::callback(const nav_msgs::Odometry::ConstPtr &odom, const mur_common::cone_msg::ConstPtr &cones)
 {
-    Path.clear();
-    Markers.clear();
-    // sortMarks.clear();
-    Left.clear();
-    Right.clear();
-    cones.clear();
-    cone_msg_received = false;
-    odom_msg_received = false;
+    if (fastLapReady || cones->x.empty())
+        return;
+    SensorFrame &frame = frames.back();
+    frame.odom = odom;
+    frame.cones = cones;
+    frames.publish();
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);   // so the wake up cannot be missed
+    }
+    plan_wake.notify_one();
 }
 
-// publish path for rviz
-void PlannerNode::pushPathViz()
+// sleeps until pred() is true or the node stops, returns false when the node stops
+bool PlannerNode::waitFor(std::condition_variable &wake, const std::function<bool()> &pred)
 {
-    nav_msgs::Path path_viz_msg;
-    path_viz_msg.header.frame_id = FRAME; //"map"
-
-    std::vector<geometry_msgs::PoseStamped> poses;
-    poses.reserve(Path.size());
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    wake.wait(lock, [&] { return pred() || !running; });
+    return running;
+}
 
-    for (int p = 0; p < Path.size(); p++)
+// planning thread, one planner update per frame
+// cones are decoded here, the changes are worked out by ingest.diff (see cone_ingest.h)
+void PlannerNode::planningLoop()
+{
+    while (waitFor(plan_wake, [this] { return frames.fresh(); }))
     {
-        geometry_msgs::PoseStamped item; 
-        item.header.frame_id = FRAME;
-        item.header.seq = p;
-        item.pose.position.x = Path[p].x;
-        item.pose.position.y = Path[p].y;
-        item.pose.position.z = 0.0;
-
-        poses.emplace_back(item);
+        frames.update();
+        if (mapLoaded)  // nothing to plan
+        {
+            outputs.back() = map_output;
+            outputs.publish();
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex);
+            }
+            publish_wake.notify_one();
+            continue;
+        }
+        const SensorFrame &frame = frames.front();
+        car_x = frame.odom->pose.pose.position.x;
+        car_y = frame.odom->pose.pose.position.y;
+        car_v = frame.odom->twist.twist.linear.x;
+        ingest.decode(frame.cones->x, frame.cones->y, frame.cones->colour);
+
+        input.cones.clear();
+        if (!plannerInitialised)
+        {
+            initialisePlanner();
+            continue;
+        }
+
+        ClockTP start = Clock::now();
+        ingest.diff(input.cones);
+        ingest_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+        input.car_x = car_x;
+        input.car_y = car_y;
+        PlannerOutput &result = outputs.back();
+        planner->update(input, result);
+        store_latency.record(result.store_us);
+        sort_latency.record(result.sort_us);
+        centre_latency.record(result.centre_us);
+        outputs.publish();
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+        }
+        publish_wake.notify_one();
+
+        if (std::chrono::duration<double>(Clock::now() - last_plan_health).count() >= HEALTH_PERIOD)
+        {
+            pushHealth({{"ingest", &ingest_latency}, {"store", &store_latency},
+                        {"sort", &sort_latency}, {"centre_points", &centre_latency}});
+            last_plan_health = Clock::now();
+        }
     }
+}
+
+// publishing thread, publishes the latest planner output
+// when the fast lap is ready it publishes an empty path and shuts ROS down
+void PlannerNode::publishingLoop()
+{
+    while (waitFor(publish_wake, [this] { return outputs.fresh() || fastLapReady; }))
+    {
+        if (fastLapReady)
+        {
+            shut_down();
+            if (standalone)
+                ros::shutdown();    // ends ros::waitForShutdown() in main
+            return;
+        }
+        outputs.update();
+        const PlannerOutput &out = outputs.front();
+        plannerComplete = out.complete;
+        if (plannerComplete)
+            SlowLapFinished(out);
+
+        ClockTP start = Clock::now();
+        pushPath(out);
+        pushPathViz(out);
+        pushMarkers(out);
+        publish_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
 
-    path_viz_msg.poses = poses;
-    pub_path_viz.publish(path_viz_msg);
+        if (std::chrono::duration<double>(Clock::now() - last_publish_health).count() >= HEALTH_PERIOD)
+        {
+            pushHealth({{"publish", &publish_latency}});
+            last_publish_health = Clock::now();
+        }
+    }
 }
 
-// publish path points for path follower
-void PlannerNode::pushPath()
+// adds p50/p99/max of one stage to the health msg and starts a new period
+static void addStageStatus(diagnostic_msgs::DiagnosticArray &msg, const char *stage, LatencyHistogram &latency)
 {
-    mur_common::path_msg msg;
-    msg.header.frame_id = FRAME;
-    for (auto &p:Path)
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = std::string("slowlap_planner/") + stage;
+    status.hardware_id = "slowlap_planner";
+    status.message = "latency (us) over the last period";
+    const char *keys[] = {"count", "p50", "p99", "max"};
+    uint64_t values[] = {latency.count(), latency.percentile(0.5), latency.percentile(0.99), latency.max()};
+    for (int i = 0; i < 4; i++)
     {
-        msg.x.push_back(p.x);
-        msg.y.push_back(p.y);
-        msg.v.push_back(p.velocity);
+        diagnostic_msgs::KeyValue kv;
+        kv.key = keys[i];
+        kv.value = std::to_string(values[i]);
+        status.values.push_back(kv);
     }
-    pub_path.publish(msg);
+    msg.status.push_back(status);
+    latency.reset();
 }
 
-// get transition flag from fast lap
-void PlannerNode::transitionCallback(const mur_common::transition_msg &msg)
+// publish stage latencies, called every HEALTH_PERIOD by the thread that owns the histograms
+void PlannerNode::pushHealth(const StageLatencies &stages)
 {
-    fastLapReady = msg.fastlapready;
+    diagnostic_msgs::DiagnosticArray msg;
+    msg.header.stamp = ros::Time::now();
+    for (auto &stage: stages)
+        addStageStatus(msg, stage.first, *stage.second);
+    pub_health.publish(msg);
 }
 
-// get odometry messages (from SLAM)
-void PlannerNode::odomCallback(const nav_msgs::Odometry &msg)
+// publish path for rviz
+void PlannerNode::pushPathViz(const PlannerOutput &out)
 {
-    car_x = msg.pose.pose.position.x;
-    car_y = msg.pose.pose.position.y;
-    car_v = msg.twist.twist.linear.x; 
-    odom_msg_received = true;
+    if (!path_viz->wanted())
+        return;
+    path_viz->points.clear();
+    for (auto &p: out.path)
+        path_viz->points.push_back({p.x, p.y, 0});
+    path_viz->commit();
 }
 
-// get cone positions (from SLAM)
-void PlannerNode::coneCallback(const mur_common::cone_msg &msg)
+// publish path points for path follower
+// only the points that changed since the last msg are sent, plus a keyframe now and then (see path_stream.h)
+void PlannerNode::pushPath(const PlannerOutput &out)
 {
-    if (msg.x.size() == 0)
-        cone_msg_received = false;
-    else
-    {
-        for (int i = 0; i < msg.x.size(); i++)
-        {
-            if (msg.colour[i] == "BLUE")
-            {
-            cones.push_back(Cone(msg.x[i], msg.y[i], 'b', i));
-            }
-            else if (msg.colour[i] == "YELLOW")
-            {
-                cones.push_back(Cone(msg.x[i], msg.y[i], 'y', i)); 
-            }
-            else if (msg.colour[i] == "na")
-            {
-                std::cout << "[PLANNER] 'na' cone colour passed, skipping" << std::endl;
-            }
-            else if (msg.colour[i] == "BIG" || msg.colour[i] == "ORANGE")
-            {
-                cones.push_back(Cone(msg.x[i], msg.y[i], 'r', i));
-            }
-        }
-        cone_msg_received = true;
-    }
+    slowlap_common::path_delta_msg::Ptr msg = boost::make_shared<slowlap_common::path_delta_msg>();
+    if (!path_stream.update(out.path, *msg))
+        return;
+    msg->header.frame_id = FRAME;
+    msg->header.stamp = ros::Time::now();
+    pub_path.publish(msg);
 }
 
-// pablish markers to rviz
-void PlannerNode::pushMarkers()
+// get transition flag from fast lap, the planner stops here
+void PlannerNode::transitionCallback(const mur_common::transition_msg &msg)
 {
-    visualization_msgs::MarkerArray marks;
-    marks.markers.resize(Markers.size()/2);
-    int j,k;
-    for (int i=0; i<marks.markers.size(); i++)
+    if (msg.fastlapready && !fastLapReady)
     {
-        j=2*i;
-        setMarkerProperties(&marks.markers[i],Markers[j],Markers[j+1],i,Markers[i].accepted);
+        fastLapReady = true;
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+        }
+        publish_wake.notify_one();  // the publishing thread shuts down
     }
-    pub_pathCones.publish(marks);
-
 }
 
-// marker properties
-// google Visualisation::Markers message for more details
-void PlannerNode::setMarkerProperties(visualization_msgs::Marker *marker,PathPoint cone1,PathPoint cone2,int n,bool accepted)
+// publish markers to rviz, all cone pairs in one LINE_LIST
+// accepted pairs are red, rejected ones purple, nothing is shown once the planner is complete
+void PlannerNode::pushMarkers(const PlannerOutput &out)
 {
-    marker->header.frame_id = FRAME;
-    marker->header.stamp = ros::Time();
-    marker->header.seq = n;
-    marker->ns = "my_namespace";
-    marker->id = n;
-    marker->type = visualization_msgs::Marker::LINE_LIST;
-    marker->action = visualization_msgs::Marker::ADD;
-    marker->lifetime = ros::Duration(1);
-    geometry_msgs::Point p1, p2;
-
-
-    marker->pose.orientation.x = 0.0;
-    marker->pose.orientation.y = 0.0;
-    marker->pose.orientation.z = 0.0;
-    marker->pose.orientation.w = 1.0;
-    marker->scale.x = 0.05;
-    p1.x = cone1.x;
-    p1.y = cone1.y;
-    p1.z = 0;
-    p2.x = cone2.x;
-    p2.y = cone2.y;
-    p2.z = 0;
-    marker->points.push_back(p1);
-    marker->points.push_back(p2);
-
-    marker->scale.x = 0.15;
-    marker->scale.y = 0.15;
-    marker->scale.z = 0.35;
-
-    // alpha and RGB settings
-    // color.a is opacity, 0: invisible
-    marker->color.a = 0.5;
-
-    if (accepted)
+    if (!path_cones->wanted())
+        return;
+    const VizColour accepted = {1.0, 0.0, 0.0, 0.5};
+    const VizColour rejected = {0.5, 0.1, 1.0, 1.0};
+    path_cones->points.clear();
+    path_cones->colours.clear();
+    if (!plannerComplete)
     {
-        marker->color.r = 1.0;
-        marker->color.g = 0.0;
-        marker->color.b = 0.0;
-    }
-    else
-    {
-        marker->color.a = 1.0;
-        marker->color.r = 0.50;
-        marker->color.g = 0.1;
-        marker->color.b = 1.0;
-        marker->lifetime = ros::Duration(0.1);
+        for (size_t i = 0; i + 1 < out.markers.size(); i += 2)
+        {
+            const VizColour &colour = out.markers[i].accepted ? accepted : rejected;
+            path_cones->points.push_back({out.markers[i].x, out.markers[i].y, 0});
+            path_cones->points.push_back({out.markers[i+1].x, out.markers[i+1].y, 0});
+            path_cones->colours.push_back(colour);
+            path_cones->colours.push_back(colour);
+        }
     }
-    if (plannerComplete)
-    marker->color.a = 0.0;
-        
+    path_cones->commit();
 }
-
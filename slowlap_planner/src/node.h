@@ -7,22 +7,28 @@
 #define SRC_NODE_H
 
 #include <ros/ros.h>                        // ROS
+#include <message_filters/subscriber.h>     // cone/odometry synchronisation
+#include <message_filters/synchronizer.h>
+#include <message_filters/sync_policies/approximate_time.h>
 #include <nav_msgs/Odometry.h>              // odometry messages
-#include <nav_msgs/Path.h>                  // path messages for rviz
-#include <geometry_msgs/PoseStamped.h>      // path messages for rviz
 #include <geometry_msgs/Pose.h>
 #include <geometry_msgs/Point.h>
-#include <visualization_msgs/Marker.h>      // rviz msgs
-#include <visualization_msgs/MarkerArray.h> // rviz msgs
+#include <slowlap_common/viz_publisher.h>   // rviz msgs, published on their own thread
 #include "mur_common/cone_msg.h"            // cone messages from slam
-#include "mur_common/path_msg.h"            // path message from planner
-#include "mur_common/diagnostic_msg.h"      // diagnostic mgs (MURauto20)
+#include "slowlap_common/path_delta_msg.h"  // path stream message from planner
+#include <slowlap_common/path_stream.h>     // works out the path changes to send
+#include <diagnostic_msgs/DiagnosticArray.h>   // stage latencies
 #include "mur_common/transition_msg.h"      // msg to transition to fast lap
 #include "mur_common/map_msg.h"             // msg for complete map
 #include <string>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 
 #include "path_planner.h"
 #include <iostream>
@@ -32,12 +38,15 @@
 #include <numeric>
 #include "cone.h"                           // cone class
 #include "path_point.h"                     // path point class
+#include <slowlap_common/latency_histogram.h>   // fixed memory latency histogram
+#include <slowlap_common/triple_buffer.h>       // lock-free handoff between the node threads
+#include <slowlap_common/track_map.h>           // binary track map file, written at the end of the slow lap
 
 // ROS topics:
 #define HUSKY_ODOM_TOPIC "/odometry/filtered"
 #define MUR_ODOM_TOPIC "/mur/slam/Odom"
 #define CONE_TOPIC "/mur/slam/cones"
-#define PATH_TOPIC "/mur/planner/path"
+#define PATH_TOPIC "/mur/planner/path_stream"
 #define PATH_CONES_TOPIC "/mur/planner/path_cones"
 #define PATH_VIZ_TOPIC "/mur/planner/path_viz"
 #define HEALTH_TOPIC "/mur/planner/topic_health"
@@ -46,90 +55,119 @@
 #define FASTLAP_READY_TOPIC "/mur/control/transition"
 #define FINISHED_MAP_TOPIC "/mur/planner/map"
 
-#define HZ 12   // publish frequency // doesnt need to be  high // should coordinate with auto steering/braking
+#define SYNC_QUEUE 10    // msgs kept per topic while looking for a matching cone/odometry pair
 #define FRAME "map"
+#define HEALTH_PERIOD 1.0   // seconds between stage latency reports on HEALTH_TOPIC
 
 typedef std::chrono::high_resolution_clock Clock;               // (MURauto20)
 typedef std::chrono::high_resolution_clock::time_point ClockTP; // (MURauto20)
+typedef message_filters::sync_policies::ApproximateTime<nav_msgs::Odometry, mur_common::cone_msg> OdomConeSync;
+typedef std::vector<std::pair<const char*, LatencyHistogram*>> StageLatencies;
+
+// matched msgs handed from the ROS callback to the planning thread (only the pointers are passed)
+struct SensorFrame
+{
+    nav_msgs::Odometry::ConstPtr odom;
+    mur_common::cone_msg::ConstPtr cones;
+};
+
+/**
+ * the node runs as a pipeline of three threads:
+ * - ROS callbacks (AsyncSpinner in main.cpp, or the nodelet manager): pairs cone/odometry msgs and hands them over in frames
+ * - planning: ingest.diff and PathPlanner::update, writes the result into outputs
+ * - publishing: converts the latest output to msgs (path, rviz, map)
+ * frames and outputs are triple buffers, so a slow stage never holds up the one before it
+ * (the latest frame/output wins), each thread only touches its own members (see comments)
+**/
 
 class PlannerNode
 {
 public:
-    PlannerNode(ros::NodeHandle, bool, float, float, float);
-    void spinThread();
+    PlannerNode(ros::NodeHandle, bool, float, float, float, const std::string&, bool, bool standalone = true);
+    ~PlannerNode();
     std::unique_ptr<PathPlanner> planner;
     void shut_down();
-    bool fastLapReady = false;
+    std::atomic<bool> fastLapReady{false};
 
 private:
 
-    bool const_velocity;
-    float v_max;
-    float v_const;
-    float max_f_gain;
-
     //see .cpp for function description
     void initialisePlanner();
+    bool loadTrackMap();
+    void saveTrackMap(const PlannerOutput&);
     int launchSubscribers();
     int launchPublishers();
-    void clearTempVectors();
-    void pushPathViz();
-    void pushPath();
-    void pushHealth(ClockTP&, ClockTP&, ClockTP&, ClockTP&);
+    void planningLoop();
+    void publishingLoop();
+    bool waitFor(std::condition_variable&, const std::function<bool()>&);
+    void pushPathViz(const PlannerOutput&);
+    void pushPath(const PlannerOutput&);
+    void pushHealth(const StageLatencies&);
     void pushSortedCones();
     void pushSortingMarkers();
-    void waitForMsgs();
-    void odomCallback(const nav_msgs::Odometry&);
-    void coneCallback(const mur_common::cone_msg&);
     void transitionCallback(const mur_common::transition_msg&);
-    void pushMarkers();
-    void callback(const nav_msgs::Odometry&, const mur_common::cone_msg&);
-    void setMarkerProperties(visualization_msgs::Marker *marker,PathPoint cone1,
-                                        PathPoint cone2,int n,bool accepted);
-    void setMarkerProperties2(visualization_msgs::Marker *marker,PathPoint cone,int id,int n,char c);
-    void SlowLapFinished();
+    void pushMarkers(const PlannerOutput&);
+    void callback(const nav_msgs::Odometry::ConstPtr&, const mur_common::cone_msg::ConstPtr&);
+    void SlowLapFinished(const PlannerOutput&);
     
 
     
     // ROS standard variables:
+    // msgs are published as shared pointers, nodelets in the same manager get them without serialisation or copies
     ros::NodeHandle nh;
-    ros::Subscriber sub_odom;
-    ros::Subscriber sub_cones;  
+    message_filters::Subscriber<nav_msgs::Odometry> sub_odom;
+    message_filters::Subscriber<mur_common::cone_msg> sub_cones;
+    std::unique_ptr<message_filters::Synchronizer<OdomConeSync>> sync;   // calls callback() with matched msgs
     ros::Publisher pub_path;
-    ros::Publisher pub_path_viz;
     ros::Publisher pub_health;
     ros::Publisher pub_control;
     ros::Publisher pub_lcones;
     ros::Publisher pub_rcones;
-    ros::Publisher pub_pathCones;
     ros::Publisher pub_map;
     ros::Subscriber sub_transition;
-    ros::Publisher pub_sorting_markers;
-    ros::Publisher pub_path_marks;
-
-    // MURauto21 didnt use these stuff, but didnt erase for future use
-    ros::Time now;                  // diagnostic stuff (MURauto20) 
-    std::vector<uint32_t> times;    // diagnostic stuff (MURauto20)
-    std::vector<uint32_t> rtimes;   // diagnostic stuff (MURauto20)
-    uint64_t compute_time;          // diagnostic stuff (MURauto20)
-
-    bool slowLapDone = false;           // flag when slow lap is done
-    bool cone_msg_received = false;     // flag when cone msgs are received by subscriber
-    bool odom_msg_received = false;     // flag when odom msgs are received by subscriber
-    bool plannerInitialised = false;    // flag when planner is initialised
-    bool plannerComplete = false;       // flag when planner is done 
+    VizPublisher viz;                   // rviz, filled by the publishing thread only if someone is watching
+    VizLayer *path_viz;                 // centre line
+    VizLayer *path_cones;               // cone pairs of the path points, one LINE_LIST
+
+    // pipeline
+    bool standalone;                            // own executable (main.cpp), false when loaded as a nodelet
+    TripleBuffer<SensorFrame> frames;           // callback -> planning thread
+    TripleBuffer<PlannerOutput> outputs;        // planning thread -> publishing thread
+    std::thread planning_thread;
+    std::thread publishing_thread;
+    std::mutex wake_mutex;                      // only used to sleep/wake the threads, not for the data
+    std::condition_variable plan_wake;          // new frame
+    std::condition_variable publish_wake;       // new output
+    std::atomic<bool> running{true};
+
+    // stage latencies (us) since the last health msg, see pushHealth()
+    LatencyHistogram ingest_latency;    // planning thread: cone msg diff
+    LatencyHistogram store_latency;     // planning thread: storing cones
+    LatencyHistogram sort_latency;      // planning thread: sorting cones
+    LatencyHistogram centre_latency;    // planning thread: centre points
+    LatencyHistogram publish_latency;   // publishing thread: path msg and rviz layers
+    ClockTP last_plan_health;           // planning thread: time of its last health msg
+    ClockTP last_publish_health;        // publishing thread: time of its last health msg
+
+    bool slowLapDone = false;           // publishing thread: flag when slow lap is done (map sent and saved)
+    std::string map_file;               // track map file (see track_map.h), written when the slow lap is complete
+    bool load_map;                      // start from map_file instead of mapping the track, if the file is valid
+    bool mapLoaded = false;             // track map loaded at startup, nothing is planned
+    TrackMapView saved_map;             // the loaded map file (mapped)
+    PlannerOutput map_output;           // planning thread: the loaded map as planner output
+    bool plannerInitialised = false;    // planning thread: flag when planner is initialised
+    bool plannerComplete = false;       // publishing thread: flag when planner is done 
+    PathStreamWriter path_stream;       // publishing thread: path changes since the last path msg
             
-    std::vector<PathPoint> Path;        // centre line points 
-    std::vector<Cone> Left;             // sorted left cones (blue)
-    std::vector<Cone> Right;            // sorted right cones (yellow)
-    std::vector<Cone> cones;            // raw cones
-    std::vector<PathPoint> Markers;     // rviz
+    PlannerConfig config;               // planner parameters
+    PlannerInput input;                 // planning thread: cone changes and car position passed to the planner
+    ConeIngest ingest;                  // planning thread: decodes cone msgs and diffs them against what the planner has
     std::vector<PathPoint> sortMarks;   // rviz
     
     PathPoint startFin;                 // start/finishline midpoint
-    float car_x;                        // car current pos x
-    float car_y;                        // car current pos y
-    float car_v;                        // car current v
+    float car_x;                        // planning thread: car current pos x
+    float car_y;                        // planning thread: car current pos y
+    float car_v;                        // planning thread: car current v
     float yaw;                          // car current yaw
     float z;                            // quaternion conversion
     float w;                            // quaternion stuff
@@ -1,25 +1,42 @@
 /**
  * This handles the path planning algorithm
- * node.cpp passes cone and car info through the function update(...)
- * new cones are copied, then sorted by colour, and by correct order in race track (not necessarily by distance)
- * Path points are then generated by taking the mid point between 2 opposite cones 
+ * node.cpp passes cone and car info through the function update(...), see PlannerInput/PlannerOutput
+ * new cones are copied and added to a Delaunay triangulation (cone_triangulation.h)
+ * Path points are the mid points of the triangulation edges between 2 opposite cones,
+ * a beam search picks the chain of mid points that makes the smoothest path up to the sensor range
+ * cones are added to the left/right cones in the order the path passes them
  * then pass back path information to node.cpp
  * 
- * for future improvement: generate velocity reference as well
+ * the velocity reference of the path points comes from the curvature and acceleration limits (velocity_profile.h)
  * 
  * author: Aldrei Recamadas (MURauto21)
  **/
 
 #include "path_planner.h"
 
-//constructor
-PathPlanner::PathPlanner(float car_x, float car_y, std::vector<Cone> &cones, bool const_velocity, float v_max, float v_const, float max_f_gain, std::vector<PathPoint>&markers)
-    : const_velocity(const_velocity), v_max(v_max), v_const(v_const), f_gain(max_f_gain), car_pos(PathPoint(car_x,car_y)),init_pos(PathPoint(car_x,car_y))
+void PlannerOutput::clear()
+{
+	path.clear();
+	left_cones.clear();
+	right_cones.clear();
+	markers.clear();
+	complete = false;
+	store_us = sort_us = centre_us = 0;
+}
+
+// microseconds between two time points, for the stage times in PlannerOutput
+static uint32_t elapsedUs(const std::chrono::steady_clock::time_point &start, const std::chrono::steady_clock::time_point &end)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+//constructor, input has all the cones seen so far
+PathPlanner::PathPlanner(const PlannerConfig &config, const PlannerInput &input)
+    : cone_grid(raw_cones, TRACKWIDTH), triangulation(raw_cones), velocity_profile(config.v_max, config.max_f_gain),
+	const_velocity(config.const_velocity), v_const(config.v_const),
+	car_pos(PathPoint(input.car_x,input.car_y)),init_pos(PathPoint(input.car_x,input.car_y))
 {
 	//set capacity of vectors
-	raw_cones.reserve(500);
-	left_unsorted.reserve(50);
-	right_unsorted.reserve(50);
 	left_cones.reserve(250);
 	right_cones.reserve(250);
 	centre_points.reserve(300);
@@ -27,40 +44,46 @@ PathPlanner::PathPlanner(float car_x, float car_y, std::vector<Cone> &cones, boo
 	cenPoints_temp2.reserve(50);
 	rejected_points.reserve(300);
 	thisSide_cone.reserve(150);
-	oppSide_cone.reserve(150);
-	oppSide_cone2.reserve(50);
-	future_cones.reserve(50);
 	timing_cones.reserve(10);
-
-	addCones(cones);								// add new cones to raw cones
-	centre_points.emplace_back(car_x,car_y);		// add the car's initial position to centre points  
-	addFirstCentrePoints();								// add centre points from sorted cones
+	beam_nodes.reserve(BEAM_WIDTH * BEAM_DEPTH * 8);
+	beam.reserve(BEAM_WIDTH * 8);
+	next_beam.reserve(BEAM_WIDTH * 8);
+	velocity_profile.reserve(300);
+	max_turn_cos = geometry::cosDeg(MAX_PATH_ANGLE1);
+	edge_params = {TRACKWIDTH, TRACKWIDTH*0.5, TRACKWIDTH*1.5, MIN_POINT_DIST, MAX_POINT_DIST, MAX_PATH_ANGLE1};
+
+	addCones(input.cones);							// add new cones to raw cones
+	centre_points.push_back(init_pos);				// add the car's initial position to centre points  
+	if (!addFirstCentrePoints())					// add centre point of the closest cone pair
+		LOG_WARN("[PLANNER] no blue/yellow cone pair near the car, retrying with the next cones");
 	centralizeTimingCones();						// get mid point of orange cones
 	if (timingCalc)
 		sortPathPoints(centre_points,init_pos);
-	resetTempConeVectors();							// Clear pointers and reset l/right_unsorted
-	if (DEBUG) std::cout << "[PLANNER] initial path points size : " << centre_points.size() <<std::endl; //this should give 3 under normal circumstances
+	updateVelocity();
+	resetTempConeVectors();							// Clear temporary vectors
+	LOG_DEBUG("[PLANNER] initial path points size : {}", centre_points.size()); //this should give 3 under normal circumstances
 }
 
 // takes car and cone infor from node.cpp then update pathpoints to be passed back to node.cpp
-void PathPlanner::update(std::vector<Cone> &new_cones, const float car_x, const float car_y,
-						 std::vector<PathPoint> &Path,
-						 std::vector<Cone> &Left,std::vector<Cone> &Right, std::vector<PathPoint> &markers, bool&plannerComp)
+// cones are only the changes since the last update (see cone_ingest.h)
+void PathPlanner::update(const PlannerInput &input, PlannerOutput &result)
 {
+	result.clear();
 	if (complete) // if race track is complete
-	{	returnResult(Path,Left,Right,markers);
-		plannerComp = true;
+	{	returnResult(result.path,result.left_cones,result.right_cones,result.markers);
+		result.complete = true;
 	}
 	else
 	{
-		car_pos = PathPoint(car_x,car_y); //update car's position
+		car_pos = PathPoint(input.car_x,input.car_y); //update car's position
 		
 		if (left_start_zone)
 		{
 			// join track if feasible
-			if (joinFeasible(car_x, car_y))
+			if (joinFeasible(input.car_x, input.car_y))
 			{
-				ROS_INFO_STREAM("[PLANNER] Race track almost complete");
+				LOG_INFO("[PLANNER] Race track almost complete");
+				updateBoundary(true);	// the path ahead is final now, its cones too
 				centre_points.push_back(init_pos);
 				reached_end_zone = true;
 				complete = true;
@@ -69,32 +92,39 @@ void PathPlanner::update(std::vector<Cone> &new_cones, const float car_x, const
 		}
 		else
 		{
-			if (calcDist(init_pos, car_pos) > 15) //if greater than 15m away
+			if (!geometry::withinDist(init_pos, car_pos, 15)) //if greater than 15m away
 				left_start_zone = true;
 		}
 		
 		if (!reached_end_zone)
 		{
-			addCones(new_cones);
+			auto stage_start = std::chrono::steady_clock::now();
+			addCones(input.cones);
+			auto stored = std::chrono::steady_clock::now();
+			result.store_us = elapsedUs(stage_start, stored);
+			if (!first_pair && addFirstCentrePoints())	// the path starts from this pair, nothing is searched without it
+			{
+				LOG_INFO("[PLANNER] first blue/yellow cone pair found");
+				sortPathPoints(centre_points,init_pos);
+				profile_from = 0;
+			}
 			updateCentrePoints();
-			if (newConesToSort)
+			auto sort_start = std::chrono::steady_clock::now();
+			updateBoundary(false);
+			result.sort_us = elapsedUs(sort_start, std::chrono::steady_clock::now());
+			if (!searchPath())
+				addCentrePoints();	// greedy fallback, e.g. while there are too few cones for a triangle
+			if (!timingCalc && !left_start_zone && !timing_cones.empty()) // if orange cones not yet passedBy
 			{
-				if (!timingCalc && !left_start_zone) // if orange cones not yet passedBy
-				{
-					centralizeTimingCones();
-					sortPathPoints(centre_points,init_pos);
-				}
-				if (!left_cones.empty() && !right_cones.empty())
-				{
-					sortAndPushCone(left_unsorted);
-					sortAndPushCone(right_unsorted);	
-					addCentrePoints();
-				}
-				
+				centralizeTimingCones();	// after the search, so the path does not jump over the cones before them
+				sortPathPoints(centre_points,init_pos);
+				profile_from = 0;
 			}
+			result.centre_us = elapsedUs(stored, std::chrono::steady_clock::now()) - result.sort_us;
 		}
 
-		returnResult(Path, Left, Right,markers);	
+		updateVelocity();
+		returnResult(result.path,result.left_cones,result.right_cones,result.markers);	
 		
 		resetTempConeVectors();
 	}
@@ -106,7 +136,7 @@ void PathPlanner::sortPathPoints(std::vector<PathPoint>&cenPoin,PathPoint&refPoi
 	
 	for (auto &p:cenPoin)
 	{
-		p.dist = calcDist(p,refPoint);
+		p.dist = geometry::dist2(p,refPoint);
 	}
 	sort(cenPoin.begin(),cenPoin.end(),comparePointDist);
 }
@@ -114,20 +144,19 @@ void PathPlanner::sortPathPoints(std::vector<PathPoint>&cenPoin,PathPoint&refPoi
 // checks whether track is (almost) finished
 bool PathPlanner::joinFeasible(const float &car_x, const float &car_y)
 {
-	float dist = calcDist(centre_points.back(), init_pos);
-	if (DEBUG) std::cout<<"[PLANNER] Distance of latest path point to finish line: "<<(dist+6)<<std::endl; //start/finish line is 6m in fron to init (rules)
-	if ( (dist) < 5 || (calcDist(car_pos,left_cones.front()->position)<CERTAIN_RANGE)) //if less than 5 or 2 meters (magic number), should define in h file
-	{
-		float angle = calcRelativeAngle(centre_points.front(), centre_points.back()) - calcRelativeAngle(centre_points.back(), *(centre_points.end() - 2));
-		// float angle = calcAngle(*(centre_points.end() - 2), centre_points.back(), centre_points.front());
-		std::cout << angle << std::endl;
-		if (abs(angle) < MAX_PATH_ANGLE1 || abs(angle)> MAX_PATH_ANGLE2)
-		{
-			return true;
-		}
-	}
-	else
+	// only the final part of the path counts, the search horizon can reach the start through cones not seen yet
+	if (fixed_points < 2)
 		return false;
+	const PathPoint &last = centre_points[fixed_points - 1];
+	const PathPoint &before = centre_points[fixed_points - 2];
+	LOG_DEBUG("[PLANNER] Distance of latest path point to finish line: {}", geometry::dist(last, init_pos)+6); //start/finish line is 6m in fron to init (rules)
+	if (geometry::withinDist(last, init_pos, 5) || geometry::withinDist(car_pos, raw_cones.position(left_cones.front()), CERTAIN_RANGE)) //if less than 5 or 2 meters (magic number), should define in h file
+	{
+		// the turn from the last path step to the start
+		return geometry::turnWithin(last.x - before.x, last.y - before.y,
+			centre_points.front().x - last.x, centre_points.front().y - last.y, max_turn_cos);
+	}
+	return false;
 }
 
 // sets the vectors to be returned to node.cpp
@@ -135,16 +164,16 @@ void PathPlanner::returnResult(std::vector<PathPoint> &cp,
 								std::vector<Cone>&Left, std::vector<Cone>&Right,std::vector<PathPoint>&markers)
 {
 	int j=0;
-	if (DEBUG) std::cout<<"[PLANNER] sent path points: "<<centre_points.size()<<std::endl;
+	LOG_DEBUG("[PLANNER] sent path points: {}", centre_points.size());
 	for (auto &e: centre_points)
 	{
 		cp.push_back(e);
 		j++;
-		if ((e.cone1 != NULL)&&(centre_points.size()-j<10)) //to show only 10 markers
+		if ((e.cone1 != NO_CONE)&&(centre_points.size()-j<10)) //to show only 10 markers
 		{
-			markers.push_back(e.cone1->position);
+			markers.push_back(raw_cones.position(e.cone1));
 			markers.back().accepted = true;
-			markers.push_back(e.cone2->position);
+			markers.push_back(raw_cones.position(e.cone2));
 			markers.back().accepted = true;
 		}
 	}
@@ -155,9 +184,9 @@ void PathPlanner::returnResult(std::vector<PathPoint> &cp,
 		rejectCount++;
 		for (auto &r: rejected_points)
 		{
-			markers.push_back(r.cone1->position);
+			markers.push_back(raw_cones.position(r.cone1));
 			markers.back().accepted = false;
-			markers.push_back(r.cone2->position);
+			markers.push_back(raw_cones.position(r.cone2));
 			markers.back().accepted = false;
 		}
 	}
@@ -165,28 +194,16 @@ void PathPlanner::returnResult(std::vector<PathPoint> &cp,
 	// push sorted cones
 	for (auto lc:left_cones)
 	{
-		Left.push_back(*lc);
+		Left.push_back(raw_cones.get(lc));
 	}
 
 	for (auto rc:right_cones)
 	{
-		Right.push_back(*rc);
+		Right.push_back(raw_cones.get(rc));
 	}
 }
 
 // calculates the angle difference. used for cone sorting
-float PathPlanner::calcAngle(const PathPoint &A, const PathPoint &B, const PathPoint &C)
-{
-	float cb_x = C.x - B.x;
-	float cb_y = C.y - B.y;
-	float ca_x = B.x - A.x;
-	float ca_y = B.y - A.y;
-
-	float angle = calcRelativeAngle(C,B) - calcRelativeAngle(B,A);
-
-	return angle;
-}
-
 // calculates angle between 2 points (global frame)
 float PathPlanner::calcRelativeAngle(const PathPoint &p1, const PathPoint &p2)
 {
@@ -196,18 +213,18 @@ float PathPlanner::calcRelativeAngle(const PathPoint &p1, const PathPoint &p2)
 
 // generates path points by getting the mid point between 2 cones.
 // points can be accepted or rejected, see if/else conditions 
-PathPoint PathPlanner::generateCentrePoint(Cone* cone_one, Cone* cone_two, bool& feasible, std::vector<PathPoint>&cenPoints_temp)
+PathPoint PathPlanner::generateCentrePoint(ConeHandle cone_one, ConeHandle cone_two, bool& feasible, std::vector<PathPoint>&cenPoints_temp)
 {
 	PathPoint midpoint(
-		(cone_one->position.x + cone_two->position.x) / 2,
-		(cone_one->position.y + cone_two->position.y) / 2
+		(raw_cones.x(cone_one) + raw_cones.x(cone_two)) / 2,
+		(raw_cones.y(cone_one) + raw_cones.y(cone_two)) / 2
 	);
 	
 	// get distance between the 2 cones, if too far or too near, not feasible
-	float dist = calcDist(cone_one->position,cone_two->position);
-	if ((dist > TRACKWIDTH*1.5)|| (dist < TRACKWIDTH*0.5))
+	float width2 = geometry::dist2(raw_cones.position(cone_one),raw_cones.position(cone_two));
+	if ((width2 > geometry::sq(TRACKWIDTH*1.5f))|| (width2 < geometry::sq(TRACKWIDTH*0.5f)))
 	{
-		if (DEBUG) std::cout << "[XX] Rejected point: (" << midpoint.x << ", " << midpoint.y << ")  cones too far or too near!"<<std::endl;
+		LOG_DEBUG("[XX] Rejected point: ({}, {})  cones too far or too near!", midpoint.x, midpoint.y);
 		midpoint.cone1 = cone_one;
 		midpoint.cone2 = cone_two;
 		rejected_points.push_back(midpoint);
@@ -216,35 +233,27 @@ PathPoint PathPlanner::generateCentrePoint(Cone* cone_one, Cone* cone_two, bool&
 	}
 	
 
-	// calc the distance to the latest path point
-	float dist_back1 = calcDist(cenPoints_temp.back(), midpoint);
-	float dist_back2 = calcDist(*(cenPoints_temp.end()-2), midpoint);
-
-	//calc the angle difference
-	float angle1 = calcRelativeAngle(cenPoints_temp.back(),midpoint); 
-	float angle2 = calcRelativeAngle(*(cenPoints_temp.end()-2),cenPoints_temp.back());
-	float angle = angle1 - angle2; //same as calcAngle(...)
-	
+	// the step from the latest path point and the turn from the step before it
+	const PathPoint &back = cenPoints_temp.back();
+	const PathPoint &back2 = *(cenPoints_temp.end()-2);
+	float step2 = geometry::dist2(back, midpoint);
+	float dx = midpoint.x - back.x, dy = midpoint.y - back.y;
+	float prev_dx = back.x - back2.x, prev_dy = back.y - back2.y;
 	
-	if ((abs(angle)<MAX_PATH_ANGLE1 ||abs(angle)>MAX_PATH_ANGLE2) && (dist_back1>MIN_POINT_DIST) && (dist_back1<MAX_POINT_DIST))
+	if (geometry::turnWithin(prev_dx, prev_dy, dx, dy, max_turn_cos) && (step2>geometry::sq(MIN_POINT_DIST)) && (step2<geometry::sq(MAX_POINT_DIST)))
 	{
-		// if (DEBUG) std::cout << "Accepted path point: (" << midpoint.x << ", " << midpoint.y << ") ";
-		// if (DEBUG) std::cout << "dist and angle: " << dist_back << " " << angle << std::endl;
 		feasible = true;
 		//record the cones
 		midpoint.cone1 = cone_one;
 		midpoint.cone2 = cone_two;
-		midpoint.angle = angle;
+		midpoint.angle = geometry::turnAngle(prev_dx, prev_dy, dx, dy);
 	}
 	else
 	{
-		if (DEBUG)
-		{
-			std::cout << "[XX] Rejected point: (" << midpoint.x << ", " << midpoint.y << ") ";
-			std::cout<<"previous points: ("<<cenPoints_temp.back().x<<", "<<cenPoints_temp.back().y<<")";
-			std::cout<<" ("<<(*(cenPoints_temp.end()-2)).x<<", "<<(*(cenPoints_temp.end()-2)).y<<")";
-			std::cout << " dist and angle: " << dist_back1 << " " << angle1<<" - "<<angle2 <<std::endl;
-		}
+		LOG_DEBUG("[XX] Rejected point: ({}, {}) dist and turn: {} {}", midpoint.x, midpoint.y, std::sqrt(step2),
+			geometry::turnAngle(prev_dx, prev_dy, dx, dy));
+		LOG_DEBUG("     previous points: ({}, {}) ({}, {})", cenPoints_temp.back().x, cenPoints_temp.back().y,
+			(*(cenPoints_temp.end()-2)).x, (*(cenPoints_temp.end()-2)).y);
 		feasible = false;
 
 		// record the cones
@@ -259,13 +268,12 @@ PathPoint PathPlanner::generateCentrePoint(Cone* cone_one, Cone* cone_two, bool&
 // adds new path points to vector centre_points. uses generateCentrePoint()
 void PathPlanner::addCentrePoints()
 {
-	if (left_cones.empty() || right_cones.empty())
+	if (centre_points.size() < 2)
 		return;
 
 	bool feasible;
 	PathPoint cp;
-	int indx1,indx2;
-	Cone* opp_cone;
+	ConeHandle opp_cone;
 	cenPoints_temp1.clear();
 	cenPoints_temp2.clear();
 
@@ -274,17 +282,22 @@ void PathPlanner::addCentrePoints()
 	cenPoints_temp1.push_back(centre_points.back());
 	cenPoints_temp2.push_back(centre_points.back());
 
+	// candidates are the cones near the end of the path, closest first
+	nearConesByDist('b');
+
 	int c = 0;
-	for (int i = leftIndx; i < left_cones.size(); i++)
+	for (int i = 0; i < thisSide_cone.size(); i++)
 	{
 		if (c==2) //so we only generate 2 new path points
 			break;
 		// only generate points from cones that havent been passed by yet, or if paired less than 3 times
-		if((!left_cones[i]->passedBy)||(left_cones[i]->paired<3))
+		if((!raw_cones.passedBy(thisSide_cone[i]))||(raw_cones.paired(thisSide_cone[i])<3))
 		{
-			opp_cone = findOppositeClosest(*left_cones[i], right_cones);
+			opp_cone = findOppositeClosest(thisSide_cone[i], 'y');
+			if (opp_cone == NO_CONE)
+				continue;
 			feasible = false;
-			cp = generateCentrePoint(left_cones[i], opp_cone, feasible,cenPoints_temp1);
+			cp = generateCentrePoint(thisSide_cone[i], opp_cone, feasible,cenPoints_temp1);
 			if (feasible)
 			{
 				c++;
@@ -295,17 +308,21 @@ void PathPlanner::addCentrePoints()
 		}
 	}
 
+	nearConesByDist('y');
+
 	c=0;
-	for (int i = rightIndx; i < right_cones.size(); i++)
+	for (int i = 0; i < thisSide_cone.size(); i++)
 	{
 		if (c==2) //so we only generate 2 new path points
 			break;
 		// only generate points from cones that havent been passed by yet, or if paired less than 3 times
-		if((!right_cones[i]->passedBy)||(right_cones[i]->paired<3))
+		if((!raw_cones.passedBy(thisSide_cone[i]))||(raw_cones.paired(thisSide_cone[i])<3))
 		{
-			opp_cone = findOppositeClosest(*right_cones[i], left_cones);
+			opp_cone = findOppositeClosest(thisSide_cone[i], 'b');
+			if (opp_cone == NO_CONE)
+				continue;
 			feasible = false;
-			cp = generateCentrePoint(right_cones[i], opp_cone, feasible,cenPoints_temp2);
+			cp = generateCentrePoint(thisSide_cone[i], opp_cone, feasible,cenPoints_temp2);
 			if (feasible)
 			{
 				c++;
@@ -324,7 +341,7 @@ void PathPlanner::addCentrePoints()
 	{
 		for(auto &p2:cenPoints_temp2)
 		{
-			if (calcDist(p1,p2)<=0.1)
+			if (geometry::withinDist(p1,p2,0.1))
 			{
 				dup=true;
 				break;
@@ -342,227 +359,380 @@ void PathPlanner::addCentrePoints()
 	sortPathPoints(temp,temp.front()); 
 	for (int i=2;i<temp.size();i++) //first 2 in temp are just copies from centre_points
 	{
-		temp[i].cone1->paired++;
-		temp[i].cone1->mapped++;
-		temp[i].cone2->paired++;
-		temp[i].cone2->mapped++;
+		raw_cones.pair(temp[i].cone1);
+		raw_cones.pair(temp[i].cone2);
 		centre_points.push_back(temp[i]);
 		
 	}
 
 }
-//for adding first Centre points at the beginning of race, 
-void PathPlanner::addFirstCentrePoints()
+// path search over the triangulation, extends centre_points from its last (fixed) point
+// every path point is the mid point of an edge between a blue and a yellow cone, the next point comes from
+// the edges that share a cone with the current one (the neighbouring triangles), so the search follows the
+// track between the cones. BEAM_WIDTH partial paths are kept at each step, cheapest first, where
+// step cost = (heading change / MAX_PATH_ANGLE1)^2 + (track width error / TRACKWIDTH)^2
+// the longest path wins (as far as cones are seen, BEAM_DEPTH points at most), then the cheapest
+// returns false if no point could be added
+bool PathPlanner::searchPath()
 {
-	sortConesByDist(init_pos);		// sort first seen cones by distance
-	centre_points.emplace_back(
-		(left_cones.front()->position.x + right_cones.front()->position.x) / 2,
-		(left_cones.front()->position.y + right_cones.front()->position.y) / 2
-	);
-	centre_points.back().cone1 = left_cones.front();
-	centre_points.back().cone2 = right_cones.front();
-	left_cones.front()->paired++;
-	left_cones.front()->mapped++;
-	right_cones.front()->paired++;
-	right_cones.front()->mapped++;
+	if (centre_points.size() < 2)
+		return false;
+
+	const PathPoint root_prev = *(centre_points.end()-2);
+	beam_nodes.clear();
+	beam.clear();
+	beam_nodes.push_back({centre_points.back(), -1, 0});
+	beam.push_back(0);
+	int best = 0;
+	for (int depth = 0; depth < BEAM_DEPTH && !beam.empty(); depth++)
+	{
+		next_beam.clear();
+		for (int node: beam)
+			expandBeam(node, root_prev);
+		size_t keep = std::min<size_t>(BEAM_WIDTH, next_beam.size());
+		std::partial_sort(next_beam.begin(), next_beam.begin() + keep, next_beam.end(),
+			[this](int a, int b) { return beam_nodes[a].cost < beam_nodes[b].cost; });
+		next_beam.resize(keep);
+		if (!next_beam.empty())
+			best = next_beam.front();
+		beam.swap(next_beam);
+	}
+	if (best == 0)
+		return false;
+
+	// the best chain is stored end to start
+	size_t first = centre_points.size();
+	for (int n = best; n > 0; n = beam_nodes[n].parent)
+		centre_points.push_back(beam_nodes[n].point);
+	std::reverse(centre_points.begin() + first, centre_points.end());
+	for (size_t i = first; i < centre_points.size(); i++)
+	{
+		raw_cones.pair(centre_points[i].cone1);
+		raw_cones.pair(centre_points[i].cone2);
+	}
+	LOG_DEBUG("[PLANNER] path search added {} points, cost {}", centre_points.size() - first, beam_nodes[best].cost);
+	return true;
 }
 
-//add new cones to the local vector of cones and sort by colour
-void PathPlanner::addCones(std::vector<Cone> &new_cones)
+// adds the feasible next points of a partial path to next_beam
+// root_prev is the path point before the end of the fixed path (for the heading at the first step)
+// the candidate edges are collected first and scored together (edgeCosts, SIMD)
+void PathPlanner::expandBeam(int node, const PathPoint &root_prev)
 {
-	updateStoredCones(new_cones);
-	int temp = left_cones.size() + right_cones.size() + timing_cones.size();
-	if (DEBUG)
+	const BeamNode from = beam_nodes[node];     // copy, beam_nodes grows below
+	const PathPoint before = (from.parent < 0) ? root_prev : beam_nodes[from.parent].point;
+
+	// branch from the cones of the current edge, or the cones around a point that has none (car start, timing cones)
+	near_cones.clear();
+	if (from.point.cone1 != NO_CONE && from.point.cone2 != NO_CONE)
 	{
-		std::cout<<"\nSLAM gives  "<<new_cones.size()<<" cones.";
-		std::cout<<" left saved cones: "<<left_cones.size();
-		std::cout<<". right saved cones: "<<right_cones.size();
-		std::cout<<". timing cones: "<<timing_cones.size();
-		std::cout<<". future cones: "<<future_cones.size()<<std::endl;
+		near_cones.push_back(from.point.cone1);
+		near_cones.push_back(from.point.cone2);
 	}
-	if (gotNewCones || !passedByAll)
-	{
+	else
+		cone_grid.radius(from.point, TRACKWIDTH, near_cones, [this](ConeHandle cn) { return raw_cones.colour(cn) != 'r'; });
 
-		for (auto &cone: future_cones)
+	edges.clear();
+	for (auto cone: near_cones)
+	{
+		triangulation.forEachNeighbour(cone, [&](ConeHandle other)
 		{
-			if (cone->colour == 'b')
-			{
-				left_unsorted.push_back(cone);
-				l_cones_sorted = false;
-				newConesToSort = true;
-			}
+			char colour = raw_cones.colour(cone);
+			if (colour == raw_cones.colour(other))
+				return;
+			ConeHandle left = (colour == 'b') ? cone : other;
+			ConeHandle right = (colour == 'b') ? other : cone;
+			if (raw_cones.sorted(left) && raw_cones.sorted(right)) // on the fixed path already
+				return;
+			if (onBeam(node, left, right))
+				return;
+			edges.push(left, raw_cones.position(left), right, raw_cones.position(right));
+		});
+	}
+	if (edges.size() == 0)
+		return;
 
-			else if (cone->colour == 'y')
-			{
-				right_unsorted.push_back(cone);
-				r_cones_sorted = false;
-				newConesToSort = true;
-			}
-			else //red cones
-			{
-				
-				timing_cones.push_back(cone);
-				if (DEBUG) std::cout<<"Timing cones found: "<< timing_cones.size() <<std::endl;	
-			
-			}
-		}
-		if (DEBUG)	std::cout<<"l and r future cones: "<<left_unsorted.size()<<" and "<<right_unsorted.size()<<std::endl;
-		
+	edgeCosts(edges, from.point.x, from.point.y, from.point.x - before.x, from.point.y - before.y, edge_params);
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		if (std::isinf(edges.cost[i]))
+			continue;
+		PathPoint midpoint((edges.lx[i] + edges.rx[i]) / 2, (edges.ly[i] + edges.ry[i]) / 2);
+		midpoint.cone1 = edges.left[i];
+		midpoint.cone2 = edges.right[i];
+		midpoint.angle = edges.angle[i];
+		beam_nodes.push_back({midpoint, node, from.cost + edges.cost[i]});
+		next_beam.push_back(beam_nodes.size() - 1);
 	}
+}
 
-	else
-		return;	
+// true if the edge between the 2 cones is already used by the partial path ending at node
+bool PathPlanner::onBeam(int node, ConeHandle left, ConeHandle right) const
+{
+	for (int n = node; n >= 0; n = beam_nodes[n].parent)
+	{
+		if (beam_nodes[n].point.cone1 == left && beam_nodes[n].point.cone2 == right)
+			return true;
+	}
+	return false;
 }
 
-// update the position of the raw cones using new cone pos
-void PathPlanner::updateStoredCones(std::vector<Cone>&new_cones)
+// cones of the given colour within MAX_POINT_DIST of the end of the path, closest first, into thisSide_cone
+// (candidates for the greedy fallback)
+void PathPlanner::nearConesByDist(char colour)
 {
-	if (raw_cones.size()!=new_cones.size())
-		gotNewCones = true;
-		
-	float dist;
-	//add new cones to raw cones while updating future cones
-	for (int i=0; i<new_cones.size();i++)
+	const PathPoint &end = centre_points.back();
+	thisSide_cone.clear();
+	cone_grid.radius(end, MAX_POINT_DIST, thisSide_cone, [this, colour](ConeHandle cn) { return raw_cones.colour(cn) == colour; });
+	sort(thisSide_cone.begin(), thisSide_cone.end(), [this, &end](ConeHandle a, ConeHandle b)
+		{ return geometry::dist2(end, raw_cones.position(a)) < geometry::dist2(end, raw_cones.position(b)); });
+}
+
+//for adding first Centre points at the beginning of race, the closest blue and yellow cones
+//returns false if there is no such pair yet (update() tries again with the next cones)
+bool PathPlanner::addFirstCentrePoints()
+{
+	ConeHandle left = cone_grid.nearest(init_pos, TRACKWIDTH*4, [this](ConeHandle cn) { return raw_cones.colour(cn) == 'b'; });
+	ConeHandle right = cone_grid.nearest(init_pos, TRACKWIDTH*4, [this](ConeHandle cn) { return raw_cones.colour(cn) == 'y'; });
+	if (left == NO_CONE || right == NO_CONE)
+		return false;
+	centre_points.emplace_back(
+		(raw_cones.x(left) + raw_cones.x(right)) / 2,
+		(raw_cones.y(left) + raw_cones.y(right)) / 2
+	);
+	centre_points.back().cone1 = left;
+	centre_points.back().cone2 = right;
+	raw_cones.pair(left);
+	raw_cones.pair(right);
+	first_pair = true;
+	return true;
+}
+
+//add new cones to the local copy, the triangulation and the grid
+void PathPlanner::addCones(const ConeDelta &new_cones)
+{
+	updateStoredCones(new_cones);
+	LOG_DEBUG("SLAM gives  {} new, {} moved, {} removed cones.", new_cones.added.size(), new_cones.moved.size(), new_cones.removed.size());
+	LOG_DEBUG(" left cones: {}. right cones: {}. timing cones: {}. triangulated cones: {}",
+		left_cones.size(), right_cones.size(), timing_cones.size(), triangulation.size());
+}
+
+// update the stored (raw) cones using the cone changes given by SLAM
+// SLAM cones are matched to stored cones by id, if the id is unknown or points to a cone that is too far
+// (SLAM re-ordered or dropped cones) the nearest stored cone of the same colour is used instead.
+// only cones that are new or have actually moved are touched
+void PathPlanner::updateStoredCones(const ConeDelta &new_cones)
+{
+	update_stamp++;
+
+	// cones near the car are now certain, their positions are no longer updated
+	near_cones.clear();
+	cone_grid.radius(car_pos, CERTAIN_RANGE, near_cones, [this](ConeHandle cn) { return !raw_cones.passedBy(cn); });
+	for (auto cn: near_cones)
 	{
-		if (i==raw_cones.size()) //add newly seen cones
-		{
-			raw_cones.push_back(new_cones[i]);
-			future_cones.push_back(&raw_cones[i]);
-		}
+		raw_cones.setPassedBy(cn);
+	}
 
-		else //update previously seen cones if not yet passed by
-		{			
-			if (!raw_cones[i].passedBy)
-			{
-				dist = calcDist(raw_cones[i].position,car_pos); //check if within range
-				if(dist<CERTAIN_RANGE)
-				{
-					raw_cones[i].passedBy = true;
-				}
-				else //if not yet within range
-				{			
-					raw_cones[i].updateConePos(new_cones[i].position);
-					if (raw_cones[i].colour == 'r')
-						timingCalc = false;
-					else
-						future_cones.push_back(&raw_cones[i]);
-				}
-			}
-			else //(if passed by but not paired, add to future cones again for sorting)
-			{
-				if (raw_cones[i].paired == 0)
-					future_cones.push_back(&raw_cones[i]);
-			}
-		}
+	// ids SLAM dropped are un-mapped, the stored cones are kept
+	for (auto id: new_cones.removed)
+	{
+		if (id >= 0 && id < id_to_slot.size())
+			id_to_slot[id] = NO_CONE;
 	}
 
-	 
-	//update left and right cones
-	if (left_cones.size()>0)
+	for (auto &new_cone: new_cones.added)
 	{
-		for(int i = left_cones.size()-1;i>=0; i--)
+		storeCone(new_cone);
+	}
+	for (auto &new_cone: new_cones.moved)
+	{
+		storeCone(new_cone);
+	}
+}
+
+// add a new cone or update the position of the stored cone it matches
+void PathPlanner::storeCone(const Cone &new_cone)
+{
+	ConeHandle stored = associateCone(new_cone);
+	if (stored == NO_CONE) //add newly seen cones
+	{
+		stored = raw_cones.push_back(new_cone);
+		raw_cones.setAssocStamp(stored, update_stamp);
+		mapConeId(raw_cones.id(stored), stored);
+		cone_grid.insert(stored);
+		if (raw_cones.colour(stored) == 'r')
 		{
-			if (!left_cones[i]->passedBy || left_cones[i]->paired==0)
-				{
-					left_cones.pop_back();
-				}
-			else
-				{
-					leftIndx = i;
-					break;
-				}
-				
+			timing_cones.push_back(stored);
+			LOG_DEBUG("Timing cones found: {}", timing_cones.size());
 		}
+		else
+			triangulation.insert(stored);
+		return;
 	}
 
-	if (right_cones.size()>0)
+	raw_cones.setAssocStamp(stored, update_stamp);
+	if (raw_cones.passedBy(stored)) //position is certain
+		return;
+
+	if (!geometry::withinDist(raw_cones.position(stored), new_cone.position, MOVE_EPS)) //update previously seen cones if they moved
 	{
-		for(int i = right_cones.size()-1; i>=0; i--)
+		PathPoint old_pos = raw_cones.position(stored);
+		raw_cones.setPosition(stored, new_cone.position);
+		cone_grid.move(stored, old_pos);
+		if (raw_cones.colour(stored) == 'r')
+			timingCalc = false;
+		else
+			triangulation.move(stored);
+	}
+}
+
+// find the stored cone that a SLAM cone corresponds to, NO_CONE if it is a new cone
+ConeHandle PathPlanner::associateCone(const Cone &new_cone)
+{
+	// same id and still close by, most of the cones are matched here
+	if (new_cone.id >= 0 && new_cone.id < id_to_slot.size() && id_to_slot[new_cone.id] != NO_CONE)
+	{
+		ConeHandle stored = id_to_slot[new_cone.id];
+		if (raw_cones.colour(stored) == new_cone.colour && raw_cones.assocStamp(stored) != update_stamp
+			&& geometry::withinDist(raw_cones.position(stored), new_cone.position, ASSOC_RADIUS))
+			return stored;
+	}
+
+	// otherwise take the nearest cone of the same colour that has not been matched yet
+	char colour = new_cone.colour;
+	ConeHandle stored = cone_grid.nearest(new_cone.position, ASSOC_RADIUS,
+		[this, colour](ConeHandle cn) { return raw_cones.colour(cn) == colour && raw_cones.assocStamp(cn) != update_stamp; });
+	if (stored == NO_CONE)
+		return NO_CONE;
+
+	// re-map the id to this cone
+	int old_id = raw_cones.id(stored);
+	if (old_id >= 0 && old_id < id_to_slot.size() && id_to_slot[old_id] == stored)
+		id_to_slot[old_id] = NO_CONE;
+	raw_cones.setId(stored, new_cone.id);
+	mapConeId(new_cone.id, stored);
+	return stored;
+}
+
+void PathPlanner::mapConeId(int id, ConeHandle cone)
+{
+	if (id < 0)
+		return;
+	if (id >= id_to_slot.size())
+		id_to_slot.resize(id+1, NO_CONE);
+	id_to_slot[id] = cone;
+}
+
+// push cone to left/right cones
+void PathPlanner::pushSorted(std::vector<ConeHandle> &sorted_cones, ConeHandle cn)
+{
+	sorted_cones.push_back(cn);
+	raw_cones.setSorted(cn);
+}
+
+// adds the cones of the fixed path points (both cones passed by) to left/right cones, in path order
+// all: also the points ahead, once the track is complete
+void PathPlanner::updateBoundary(bool all)
+{
+	boundary_index = std::min(boundary_index, centre_points.size());
+	for (; boundary_index < centre_points.size(); boundary_index++)
+	{
+		const PathPoint &p = centre_points[boundary_index];
+		if (p.cone1 == NO_CONE || p.cone2 == NO_CONE) // car start or timing cones point
+			continue;
+		if (!all && (!raw_cones.passedBy(p.cone1) || !raw_cones.passedBy(p.cone2)))
+			break;
+		for (auto cn: {p.cone1, p.cone2})
 		{
-			if (!right_cones[i]->passedBy || right_cones[i]->paired==0)
-				{
-					right_cones.pop_back();
-				}
-			else
-				{
-					rightIndx = i;
-					break;
-				}
+			if (!raw_cones.sorted(cn))
+				addBoundaryCone((raw_cones.colour(cn) == 'b') ? left_cones : right_cones, cn);
 		}
 	}
+}
 
-	
+// push cone to left/right cones, plus the cone between it and the last one if the path skipped that
+// (same colour, not sorted, shares a triangulation edge with both)
+void PathPlanner::addBoundaryCone(std::vector<ConeHandle> &side, ConeHandle cone)
+{
+	if (!side.empty())
+	{
+		ConeHandle skipped = NO_CONE;
+		char colour = raw_cones.colour(cone);
+		triangulation.forEachNeighbour(side.back(), [&](ConeHandle between)
+		{
+			if (skipped != NO_CONE || between == cone || raw_cones.sorted(between) || raw_cones.colour(between) != colour)
+				return;
+			triangulation.forEachNeighbour(between, [&](ConeHandle n) { if (n == cone) skipped = between; });
+		});
+		if (skipped != NO_CONE)
+			pushSorted(side, skipped);
+	}
+	pushSorted(side, cone);
 }
 
 
+// pops the path points after the first one whose cones have not been passed by yet (the search horizon)
+// only the points up to there are final, on the way back to the start the horizon reaches cones passed long ago
 void PathPlanner::updateCentrePoints()
 {
 	
 	int temp = centre_points.size();
-	float dist;
-	float min_dist = 9000;
-	int nearest_indx=-1;
-	std::cout<<"centre points size before update: "<<temp<<std::endl;
+	LOG_DEBUG("centre points size before update: {}", temp);
 	if (temp <= 2)
 	{	
-		std::cout<<"\n";
+		fixed_points = temp;
 		return;
 	}
 	else
 	{
-		//searchfor the nearest path point
-		for (int i = centre_points.size()-1; i>=0; i--)
+		size_t keep = std::max(fixed_points, (size_t)2);
+		while (keep < centre_points.size())
 		{
-			dist = calcDist(car_pos,centre_points[i]);
-			if (dist<min_dist)
-			{
-				min_dist = dist;
-				nearest_indx = i;
-			}
-			else
+			const PathPoint &p = centre_points[keep];
+			if ((p.cone1 != NO_CONE) && (p.cone2 != NO_CONE) && (!raw_cones.passedBy(p.cone1) || !raw_cones.passedBy(p.cone2)))
 				break;
+			keep++;
 		}
-		
-		// pop path points if their cones havent been passed by yet
-		for (int i = centre_points.size()-1;i>1;i--)
+		// NO_CONE is used for the timing point, since there can be 4 orange cones. it is placed again if it is last
+		while (centre_points.size() > keep || (centre_points.size() > 2 && (centre_points.back().cone1 == NO_CONE || centre_points.back().cone2 == NO_CONE)))
 		{
-			if((centre_points[i].cone1 == NULL)||(centre_points[i].cone2 == NULL)) //for orange cones 
-			// NULL is used since there can be 4 orange cones
+			if((centre_points.back().cone1 == NO_CONE)||(centre_points.back().cone2 == NO_CONE)) //for orange cones 
 			{
-				centre_points.pop_back();
 				timingCalc = false;
-				if (DEBUG) std::cout<<"timing cones path point popped!"<<std::endl;
-			}
-			else if(!centre_points[i].cone1->passedBy || !centre_points[i].cone2->passedBy)
-			{
-				centre_points.back().cone1->paired --;
-				centre_points.back().cone2->paired --;
-				centre_points.pop_back();
+				LOG_DEBUG("timing cones path point popped!");
 			}
 			else
-				break;
-		}
-		 
-		//experimental: i want to only have at least 2 path points ahead, so pop
-		if (nearest_indx!=-1 || (nearest_indx+2) < centre_points.size()-1)
-		{
-			for (int i = centre_points.size()-1;i>nearest_indx+2;i--)
 			{
-				centre_points.back().cone1->paired --;
-				centre_points.back().cone2->paired --;
-				centre_points.pop_back();
-				std::cout<<"  experimental "<<std::endl;
+				raw_cones.unpair(centre_points.back().cone1);
+				raw_cones.unpair(centre_points.back().cone2);
 			}
-			
-	
+			centre_points.pop_back();
 		}
-
-
-		std::cout<<"  centre points size after update: "<<centre_points.size()<<std::endl;
+		
+		fixed_points = centre_points.size();
+		profile_from = std::min(profile_from, fixed_points);
+		LOG_DEBUG("  centre points size after update: {}", centre_points.size());
 	}
 }
      
 
+// sets the velocity of the path points that changed since the last update (and of the points before them
+// that have to brake earlier now), v_const everywhere if the velocity is constant
+void PathPlanner::updateVelocity()
+{
+	if (const_velocity)
+	{
+		for (size_t i = profile_from; i < centre_points.size(); i++)
+			centre_points[i].velocity = v_const;
+	}
+	else
+	{
+		size_t changed = velocity_profile.update(centre_points, profile_from);
+		LOG_DEBUG("[PLANNER] velocity profile updated from point {} of {}", changed, centre_points.size());
+	}
+	profile_from = centre_points.size();
+}
+
 // get midpoint of orange cones
 void PathPlanner::centralizeTimingCones()
 {
@@ -576,16 +746,16 @@ void PathPlanner::centralizeTimingCones()
 	
 	for (int i = 0; i < timing_cones.size(); i++)
 	{
-		avg_point.x += timing_cones[i]->position.x; // summation of x positions
-		avg_point.y += timing_cones[i]->position.y; // summation of y positions
+		avg_point.x += raw_cones.x(timing_cones[i]); // summation of x positions
+		avg_point.y += raw_cones.y(timing_cones[i]); // summation of y positions
 	} 
 	avg_point.x = avg_point.x / timing_cones.size(); // avg x dist
 	avg_point.y = avg_point.y / timing_cones.size(); // avg y dist
 
 
 	// Calc distance to timing cone
-	PathPoint coneTemp(timing_cones.front()->position.x,timing_cones.front()->position.y);
-	float dist = calcDist(coneTemp, avg_point);
+	PathPoint coneTemp(raw_cones.x(timing_cones.front()),raw_cones.y(timing_cones.front()));
+	float dist = geometry::dist(coneTemp, avg_point);
 	float angle = calcRelativeAngle(init_pos, avg_point);
 	
 	// if (dist > 0.1*TRACKWIDTH && dist < TRACKWIDTH && (abs(angle)<10))
@@ -593,8 +763,7 @@ void PathPlanner::centralizeTimingCones()
 	if  (dist < TRACKWIDTH && abs(angle)<20)
 	{
 		startFinish = avg_point;
-		if (DEBUG) std::cout << "Average timing cones position calculated  ";
-		if (DEBUG) std::cout << "dist: "<<dist<<" angle: "<<angle<<std::endl;
+		LOG_DEBUG("Average timing cones position calculated  dist: {} angle: {}", dist, angle);
 		timingCalc = true;
 		// startFinish.cone1 = timing_cones.front();
 		// startFinish.cone2 = timing_cones.back();
@@ -602,17 +771,13 @@ void PathPlanner::centralizeTimingCones()
 		centre_points.push_back(startFinish);
 		for (auto &t:timing_cones)
 		{
-			t->paired++;
+			raw_cones.pair(t);
 		}
 
 	}
 	else
 	{
-		if (DEBUG)
-		{
-			std::cout << "[XX] Average timing cones position NOT calculated" <<std::endl;
-			std::cout << "dist: "<<dist<<" angle: "<<angle<<std::endl;
-		}
+		LOG_DEBUG("[XX] Average timing cones position NOT calculated dist: {} angle: {}", dist, angle);
 		timingCalc = false;
 	}
 
@@ -620,99 +785,25 @@ void PathPlanner::centralizeTimingCones()
 	
 }
 
-// find the closest cone on the opposite side
-//this is mostly used on the last cone in the vector,
-Cone* PathPlanner::findOppositeClosest(const Cone &cone, const std::vector<Cone*> &cones)
+// find the closest cone of the given (opposite) colour using the grid
+// only looks within 2 track widths, anything further can't be paired anyway (see generateCentrePoint)
+// returns NO_CONE if there is no such cone
+ConeHandle PathPlanner::findOppositeClosest(ConeHandle cone, char colour)
 {
-	float min_dist = 9999; //large number
-	float dist;
-	Cone* closest_cone = cones.back();
-	int count = 0;
-	for (int i = cones.size()-1; i>=0;i--)
-	{
-		dist = calcDist(cone.position, cones[i]->position);
-		if (dist < min_dist)
-		{
-			count = 0;
-			min_dist = dist;
-			closest_cone = cones[i];
-		}
-		// if after 10 cones, the closest cone has not been replaced, break and return current closest cone
-		// this keeps it from going through all the cones
-		if (count == 10)
-			break; 
-
-		count ++;
-	}
-	return closest_cone;
+	return cone_grid.nearest(raw_cones.position(cone), TRACKWIDTH*2,
+		[this, colour](ConeHandle cn) { return raw_cones.colour(cn) == colour; });
 }
 
-//sorts the cones by distance to car, then adds the closes cone to left/right
-void PathPlanner::sortConesByDist(const PathPoint &pos)
-{
-	if (left_unsorted.empty() || right_unsorted.empty())
-		return;
-
-	// Assign distance Cone objects on left
-    for (auto &cone: left_unsorted)
-    {cone->dist = calcDist(pos, cone->position);}
-
-	// Assign distance to Cone objects on right
-    for (auto &cone: right_unsorted) 
-    {cone->dist = calcDist(pos, cone->position);}
-
-	//sort both cones_to_add vectors
-	if (left_unsorted.size()>1)
-    sort(left_unsorted.begin(), left_unsorted.end(), compareConeDist);
-	if (right_unsorted.size()>1)
-    sort(right_unsorted.begin(), right_unsorted.end(), compareConeDist);
-
-    l_cones_sorted = true;
-    r_cones_sorted = true;
-
-	for (auto &cn:left_unsorted)
-	{
-		left_cones.push_back(cn);
-	}
-	for (auto &cn:right_unsorted)
-	{
-		right_cones.push_back(cn);
-	}
-}
-bool PathPlanner::compareConeDist(Cone* const &cone_one, Cone* const &cone_two)
-{
-    return cone_one->dist < cone_two->dist;
-}
 bool PathPlanner::comparePointDist(PathPoint& pt1, PathPoint& pt2)
 {
 	return pt1.dist < pt2.dist;
 }
-bool PathPlanner::compareConeCost(Cone* const &cone_one, Cone* const &cone_two)
-{
-    return cone_one->cost < cone_two->cost;
-}
 
-/* Calculate the distance between 2 points */
-float PathPlanner::calcDist(const PathPoint &p1, const PathPoint &p2)
-{
-    float x_dist = pow(p2.x - p1.x, 2);
-    float y_dist = pow(p2.y - p1.y, 2);
 
-    return sqrt(x_dist + y_dist);
-}
 
 void PathPlanner::resetTempConeVectors()
 {
-	left_unsorted.clear();
-	right_unsorted.clear();
-	oppSide_cone.clear();
 	thisSide_cone.clear();
-	future_cones.clear();
-	l_cones_sorted = false;
-	r_cones_sorted = false;
-	newConesToSort = false;
-	newConesSorted = false;
-	gotNewCones = false;
 	if (rejectCount > 5)
 	{
 		rejected_points.clear();
@@ -720,156 +811,3 @@ void PathPlanner::resetTempConeVectors()
 	}
 }
 
-void PathPlanner::removeFirstPtr(std::vector<Cone*>& cone_vec)
-{
-    if (cone_vec.size() > 0 && cone_vec.front() != NULL)
-    {
-        cone_vec.erase(cone_vec.begin());
-    }
-}
-
-// cost 1: distance between cones of same colour
-float PathPlanner::computeCost1(Cone* &cn1, Cone* &cn2)
-{
-	return calcDist(cn1->position,cn2->position);
-}
-
-// cost 2a: distance between nearest cone from opposite side, used during initialisation when only few cones are seen
-float PathPlanner::computeCost2a(Cone* &cn1, std::vector<Cone*> &oppCone1,std::vector<Cone*> &oppCone2)
-{
-	Cone* opp_cone = findOppositeClosest(*cn1,oppCone1);
-	float dist1 = calcDist(cn1->position,opp_cone->position);
-	float dist2 = 99; //random large number
-	if (oppCone2.size()>0)
-	{
-		Cone* opp_cone2 = findOppositeClosest(*cn1,oppCone2);
-		dist2 = calcDist(cn1->position,opp_cone2->position);
-	}
-
-	return std::min(dist1,dist2);
-}
-
-// cost 2b: distance between cone nearest to car  from opposite side 
-float PathPlanner::computeCost2b(Cone* &cn1, std::vector<Cone*> &oppCone)
-{
-	for (int i=oppCone.size()-1;i>=0;i--)
-	{
-		if (oppCone[i]->passedBy)
-		{
-			return calcDist(cn1->position,oppCone[i]->position);
-		}
-	}
-}
-
-// cost 3: change in track curvature cn2 is sorted cone
-float PathPlanner::computeCost3(Cone* &cn1, std::vector<Cone*> &cn2)
-{
-	if (cn2.size()<2)
-		return 0;
-	int i = cn2.size()-1;
-	float theta1 =  atan2((cn2[i]->position.y - cn2[i-1]->position.y),(cn2[i]->position.x - cn2[i-1]->position.x));
-	float theta2 =  atan2((cn2[i]->position.y - cn1->position.y),(cn2[i]->position.x - cn1->position.x));
-	return theta1 - theta2;
-}
-
-
-// this function sorts the cones using the cost function,
-// then pushes the cones to the sorted vector left/right
-void PathPlanner::sortAndPushCone(std::vector<Cone*> &cn)
-{
-	
-	if (cn.size() == 0)
-		return;
-
-	float cost, cost1, cost2, cost3;
-	int index = 0;
-	char colour;
-	thisSide_cone.clear();
-	oppSide_cone.clear();
-	oppSide_cone2.clear();
-
-	if (cn.front()->colour == 'b') //if cone is blue(left)
-	{
-		colour = 'b';
-		thisSide_cone.assign(left_cones.begin(),left_cones.end());
-		oppSide_cone.assign(right_cones.begin(),right_cones.end());
-		if (right_unsorted.size()>0)
-			oppSide_cone2.assign(right_unsorted.begin(),right_unsorted.end());
-
-	}
-	else if (cn.front()->colour == 'y') //if cone is yellow(right)
-	{
-		colour = 'y';
-		thisSide_cone.assign(right_cones.begin(),right_cones.end());
-		oppSide_cone.assign(left_cones.begin(),left_cones.end());
-		if (left_unsorted.size()>0)
-			oppSide_cone2.assign(left_unsorted.begin(),left_unsorted.end());
-	}
-	
-	if (DEBUG) std::cout<<"cone to be sorted size: "<<cn.size()<<std::endl;
-
-	if (cn.size()<2) //if only 1 cone is seen, compute cost 2 (dist to opposite side) and compare to track width
-	{
-		float cost2 = computeCost2a(cn.back(),oppSide_cone,oppSide_cone2); //consider unsorted cone as well or this case
-		if (cost2 < TRACKWIDTH*1.25)
-		{
-			if (colour == 'b')
-			{
-				left_cones.push_back(cn.back());
-			}
-			else if (colour == 'y')
-			{
-				right_cones.push_back(cn.back());
-			}
-			newConesSorted = true;
-			return;
-		}
-		else
-		{
-			return;
-		}
-			
-
-	}
-		
-
-	else if (cn.size() > 1)
-	{
-		for (int i=0;i<cn.size();i++)
-		{		
-			cost1 = computeCost1(cn[i],thisSide_cone.back());
-			cost2 = computeCost2b(cn[i],oppSide_cone);//only consider sorted cones
-			cost3 = computeCost3(cn[i],thisSide_cone);
-
-			// might need to add different weights for each cost later,
-			// but it works with equal weights for now
-			cn[i]->cost = (cost1*cost1) + (2*cost2*cost2) + (1.5*cost3*cost3);
-			
-		}
-
-		sort(cn.begin(), cn.end(), compareConeCost);
-
-		if (colour == 'b')
-		{
-			for (auto &c:cn)
-			{
-				left_cones.push_back(c);
-			}
-			
-			
-		}
-		else if (colour == 'y')
-		{
-			for (auto &c:cn)
-			{
-				right_cones.push_back(c);
-			}
-		}
-		newConesSorted = true;
-	}
-
-	
-
-}
-
-
@@ -1,13 +1,13 @@
 /**
  * This is the Path planner header file
  * see comments for description of each member
+ * the planner does not depend on ROS, node.cpp converts msgs to PlannerInput and PlannerOutput to msgs
 */
 
 #ifndef SRC_PATH_PLANNER_H
 #define SRC_PATH_PLANNER_H
 
 
-#include <ros/ros.h>
 #include <iostream>
 #include <algorithm>
 #include <math.h>
@@ -16,98 +16,140 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <chrono>
 #include "cone.h"
 #include "path_point.h"
+#include "cone_arena.h"
+#include "cone_grid.h"
+#include "cone_triangulation.h"
+#include "edge_cost.h"
+#include "cone_ingest.h"
+#include "velocity_profile.h"
+#include <slowlap_common/log.h>   // LOG_DEBUG etc, debug messages can be compiled out (SLOWLAP_LOG_LEVEL)
+#include <slowlap_common/geometry.h>  // distances and turn checks
+#include <slowlap_common/vehicle_limits.h>  // defaults of the speed params
 
 #define TRACKWIDTH 4
 #define MAX_PATH_ANGLE1 50      // angle constraint for the path point formed
-#define MAX_PATH_ANGLE2 310     // angle constraint for the path point formed
 #define MAX_POINT_DIST 8       // distance constraint for path point formed
 #define MIN_POINT_DIST 0.5      // distance constraint for path point formed
 #define CERTAIN_RANGE 5.5         // if cone is within this range, cone positions are certain and no longer updated
+#define ASSOC_RADIUS 1.5        // max distance for a SLAM cone to be matched to a stored cone (same colour cones are ~3m apart)
+#define BEAM_WIDTH 4            // partial paths kept at each step of the path search
+#define BEAM_DEPTH 40           // max path points added per search (~2 per blue/yellow cone pair, covers the sensor range)
 
 
-const bool DEBUG = true;        //  to show debug messages, switch to false to turn off
+// planner parameters (ROS params in main.cpp)
+struct PlannerConfig
+{
+    bool const_velocity = false;     // every path point gets v_const, no velocity profile
+    float v_max = DEFAULT_V_MAX;    // velocity limit of the profile (m/s)
+    float v_const = DEFAULT_V_CONST;
+    float max_f_gain = DEFAULT_MAX_F_GAIN;  // lateral acceleration limit of the profile (m/s^2), v = sqrt(max_f_gain * radius)
+};
+
+// planner inputs: cone changes since the last update (all cones for the first one) and car position
+struct PlannerInput
+{
+    ConeDelta cones;
+    float car_x = 0;
+    float car_y = 0;
+};
+
+// partial path in the path search, a chain of midpoints back to the end of the fixed path
+struct BeamNode
+{
+    PathPoint point;        // midpoint, cone1 (blue) and cone2 (yellow) are the edge it was taken from
+    int parent;             // index in PathPlanner::beam_nodes, -1 for the end of the fixed path
+    float cost;             // sum of the step costs, see searchPath()
+};
+
+// planner outputs, filled by every update
+struct PlannerOutput
+{
+    std::vector<PathPoint> path;        // centre line points
+    std::vector<Cone> left_cones;       // left cones (blue) in track order
+    std::vector<Cone> right_cones;      // right cones (yellow) in track order
+    std::vector<PathPoint> markers;     // cone pairs of path points, for rviz
+    bool complete = false;              // flag when race track is complete
+
+    // time spent in each stage of this update, microseconds (for the node's latency histograms)
+    uint32_t store_us = 0;              // storing new/moved cones
+    uint32_t sort_us = 0;               // adding passed cones to left and right cones
+    uint32_t centre_us = 0;             // updating centre points and the path search
+    void clear();
+};
 
 class PathPlanner 
 {
 public:
-    PathPlanner(float, float, std::vector<Cone>&, bool, float, float, float, std::vector<PathPoint>&);
-    void update(std::vector<Cone>&, const float, const float, std::vector<PathPoint>&,
-    std::vector<Cone> &,std::vector<Cone> &,std::vector<PathPoint>&, bool&);
+    PathPlanner(const PlannerConfig&, const PlannerInput&);
+    void update(const PlannerInput&, PlannerOutput&);
     bool complete = false;
 
 private:
     std::vector<PathPoint> centre_points;                   // vector of path points
     std::vector<PathPoint> cenPoints_temp1,cenPoints_temp2 ;// temporary vector
     std::vector<PathPoint> rejected_points;                 // rejected path points, for visualisation purposes
-    std::vector<Cone> raw_cones;                            // copy of cones passed by SLAM
-    std::vector<Cone*> future_cones;                        // pointer to cones to be sorted
-    std::vector<Cone*> left_cones;		    // Cones on left-side of track (sorted)
-    std::vector<Cone*> right_cones;		    // Cones on right-side of track (sorted)
-    std::vector<Cone*> timing_cones;        // pointer to Orange cones		
-    std::vector<Cone*> left_unsorted;       // pointer to left cones (unsorted)
-    std::vector<Cone*> right_unsorted;      // pointer to right cones (unsorted)
-    std::vector<Cone*> thisSide_cone;       // (temporary var) pointer to cones on one side, used for cone sorting and generating path points
-    std::vector<Cone*> oppSide_cone;        // (temporary var) pointer to opposite side cones, used for cone sorting and generating path points
-    std::vector<Cone*> oppSide_cone2;       // (temporary var) poiner to opposite cone, used for cone sorting and generating path points
+    ConeArena raw_cones;                                    // copy of cones passed by SLAM
+    std::vector<ConeHandle> left_cones;	    // Cones on left-side of track, in the order the path passed them
+    std::vector<ConeHandle> right_cones;	    // Cones on right-side of track, in the order the path passed them
+    std::vector<ConeHandle> timing_cones;   // handle to Orange cones
+    std::vector<ConeHandle> thisSide_cone;  // (temporary var) handle to cones on one side, used by the greedy fallback
+    std::vector<ConeHandle> near_cones;     // (temporary var) result of grid radius queries
+    std::vector<ConeHandle> id_to_slot;     // SLAM cone id -> cone in raw_cones, NO_CONE if not mapped
+    ConeGrid cone_grid;                     // spatial index of raw_cones, for nearest/radius queries
+    ConeTriangulation triangulation;        // Delaunay triangulation of the blue and yellow cones, path candidates
+    std::vector<BeamNode> beam_nodes;       // (temporary var) every partial path of the current search
+    std::vector<int> beam, next_beam;       // (temporary var) beam_nodes kept at the current/next search step
+    EdgeBatch edges;                        // (temporary var) candidate edges of one search step
+    EdgeCostParams edge_params;             // path step limits for edgeCosts
+    float max_turn_cos;                     // cos(MAX_PATH_ANGLE1), for geometry::turnWithin
+    VelocityProfile velocity_profile;       // reference velocity of centre_points
     
     PathPoint car_pos;              // current car position
     PathPoint init_pos;             // initial position of car
     PathPoint startFinish;          // mid point of star/finish line(orange cones)
     bool timingCalc = false;        // flag when orange cones have given a path point
-    bool needToSort = false;
-    bool newConesToSort = false;    // flag when there are new cones to be sorted
-    bool newConesSorted = false;    // flag when cones are sorted
-    bool timingEmpty = true;        // flag when no range cones have been seen
-    bool l_cones_sorted = false;    // flag when left cones are sorted
-    bool r_cones_sorted = false;    // flag when right cones are sorted
+    bool first_pair = false;        // flag when the closest blue/yellow pair has given a path point, retried every update until then
     bool left_start_zone = false;   // flag when car is x metres away from orange cones
     bool reached_end_zone = false;  // flag wheh near the end, slow lap almost finished
-    bool gotNewCones = false;       // flag when there are new cones
-    bool passedByAll = false;       // flag when all cones have been passed by
-    int leftIndx = 0;               // index of left cones vector
-    int rightIndx = 0;              // index of right cones vector            
-    int passedByIndex = 0;          // index used for raw_cones
-    int passedByPntIndx = 2;        // index used for centre_points, does not need to start at 0
+    size_t boundary_index = 0;      // centre_points before this index have their cones in left/right cones
+    size_t fixed_points = 0;        // centre_points before this index are final (cones passed by), the rest is the search horizon
+    size_t profile_from = 0;        // centre_points from this index changed since the last velocity update
     int rejectCount = 0;            // visulisation of rejected points
+    unsigned int update_stamp = 0;  // counts calls to updateStoredCones
     
     bool const_velocity;
     bool first_run = true;
-    float v_max;
     float v_const;
-    float f_gain;
 
     // see .cpp file for function descriptions
-    Cone* findOppositeClosest(const Cone&, const std::vector<Cone*>&);
-    void addFirstCentrePoints();
+    ConeHandle findOppositeClosest(ConeHandle, char);
+    bool addFirstCentrePoints();
     void addCentrePoints();
-    void sortConesByDist(const PathPoint&);
-    static bool compareConeDist(Cone* const&, Cone* const&);
-    void popConesToAdd();
-    void calcSpline();
-    void addCones(std::vector<Cone>&);
-    void addVelocityPoints();
-    float calcRadius(const PathPoint&, const PathPoint&, const PathPoint&);
-    float calcDist(const PathPoint&, const PathPoint&);
-    void removeFirstPtr(std::vector<Cone*>&);
+    void nearConesByDist(char);
+    bool searchPath();
+    void expandBeam(int, const PathPoint&);
+    bool onBeam(int, ConeHandle, ConeHandle) const;
+    void addCones(const ConeDelta&);
     void resetTempConeVectors();
     void returnResult(std::vector<PathPoint>&,std::vector<Cone>&,
                                                     std::vector<Cone>&,std::vector<PathPoint>&);
     void centralizeTimingCones();
-    static float calcAngle(const PathPoint&, const PathPoint&, const PathPoint&);
     static float calcRelativeAngle(const PathPoint&, const PathPoint&);
     bool joinFeasible(const float&, const float&);
-    PathPoint generateCentrePoint(Cone*, Cone*, bool&, std::vector<PathPoint>&);
-    void updateStoredCones(std::vector<Cone>&);
+    PathPoint generateCentrePoint(ConeHandle, ConeHandle, bool&, std::vector<PathPoint>&);
+    void updateStoredCones(const ConeDelta&);
+    void storeCone(const Cone&);
+    ConeHandle associateCone(const Cone&);
+    void mapConeId(int, ConeHandle);
+    void pushSorted(std::vector<ConeHandle>&, ConeHandle);
+    void updateBoundary(bool);
+    void addBoundaryCone(std::vector<ConeHandle>&, ConeHandle);
     void updateCentrePoints();
-    float computeCost1(Cone* &cn1, Cone* &cn2);
-    float computeCost2a(Cone* &cn1, std::vector<Cone*> &oppCone1,std::vector<Cone*> &oppCone2);
-    float computeCost2b(Cone* &cn1, std::vector<Cone*> &oppCone);
-    float computeCost3(Cone* &cn1, std::vector<Cone*> &cn2);
-    static bool compareConeCost(Cone* const&, Cone* const&);
+    void updateVelocity();
     static bool comparePointDist(PathPoint& pt1, PathPoint& pt2);
-    void sortAndPushCone(std::vector<Cone*> &cn);
     void sortPathPoints(std::vector<PathPoint>&,PathPoint&);
 
 };
@@ -4,36 +4,33 @@
  * 
 */
 
-/**
- * To do:
- * check not used member and see if ok to delete
-*/
-
 #ifndef SRC_PATH_POINT_H
 #define SRC_PATH_POINT_H
 
+#include <cstdint>
 #include "cone.h"
 
 struct Cone; //incomplete type for cyclic dependency problem
 
+typedef uint32_t ConeHandle;                // index of a cone in the planner's ConeArena (see cone_arena.h)
+const ConeHandle NO_CONE = 0xFFFFFFFF;      // handle for "no cone"
+
 struct PathPoint
 {
     PathPoint();                // Constructor
     PathPoint(float, float);    // Constructor
     float x;			        // Corresponding to x position on map
     float y;			        // Corresponding to y position on map
-    float z = 0;                //
-    float radius = 0;           // not used
-    float velocity = 0;         // not yet used
-    float angle = 0;            // not used
-    float dist;                 // distance to car, used for sorting
-    Cone* cone1 = NULL;         // to determine from which cone the point was formed
-    Cone* cone2 = NULL;         // to determine from which cone the point was formed
+    float velocity = 0;         // reference velocity (m/s), see velocity_profile.h
+    float angle = 0;            // turn from the previous path point (degrees), set by the path search
+    float dist;                 // squared distance to a reference point, used for sorting
+    ConeHandle cone1 = NO_CONE; // to determine from which cone the point was formed
+    ConeHandle cone2 = NO_CONE; // to determine from which cone the point was formed
     bool accepted = false;      // to determine if path point is acceptable
 };
 
-PathPoint::PathPoint() {}
-PathPoint::PathPoint(float X, float Y)
+inline PathPoint::PathPoint() {}
+inline PathPoint::PathPoint(float X, float Y)
 	: x(X), y(Y) {}
 
 
@@ -0,0 +1,38 @@
+/**
+ * This is the planner as a nodelet
+ * runs PlannerNode inside a nodelet manager, so path and cone msgs to/from the other
+ * slow lap nodelets are passed as pointers instead of being serialised (see launch/slow_lap_nodelets.launch)
+ * parameters are the same as for the slowlap_planner executable (see main.cpp)
+**/
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include "node.h"
+
+namespace slowlap_planner
+{
+
+class PlannerNodelet : public nodelet::Nodelet
+{
+private:
+    std::unique_ptr<PlannerNode> node;
+
+    void onInit() override
+    {
+        ros::NodeHandle &nh = getNodeHandle();
+        bool constant_v = nh.param<bool>("constant_v", false);
+        float v_max = nh.param<float>("v_max", DEFAULT_V_MAX);
+        float v_const = nh.param<float>("v_const", DEFAULT_V_CONST);
+        float max_f_gain = nh.param<float>("max_f_gain", DEFAULT_MAX_F_GAIN);
+        std::string map_file = nh.param<std::string>("map_file", "slowlap_track.map");
+        bool load_map = nh.param<bool>("load_map", false);
+
+        // callbacks run on this nodelet's queue, the node does not shut ROS down when the slow lap is over
+        node.reset(new PlannerNode(nh, constant_v, v_max, v_const, max_f_gain, map_file, load_map, false));
+        NODELET_INFO_STREAM("[PLANNER] nodelet loaded");
+    }
+};
+
+} // namespace slowlap_planner
+
+PLUGINLIB_EXPORT_CLASS(slowlap_planner::PlannerNodelet, nodelet::Nodelet)
@@ -0,0 +1,78 @@
+/**
+ * velocity profile of the path, see velocity_profile.h
+ * the forward pass depends only on the points before, the backward pass only on the points after,
+ * so after the path changed from index from:
+ * - curvature and forward pass are recomputed from from-1 (its curvature depends on point from) to the end
+ * - the backward pass runs from the end down until a point before from-1 keeps its velocity,
+ *   the velocities before it cannot change either (at most the braking distance, a few points)
+ **/
+
+#include "velocity_profile.h"
+#include <cmath>
+#include <algorithm>
+#include <slowlap_common/geometry.h>
+
+VelocityProfile::VelocityProfile(float v_max, float max_lat_acc)
+    : v_max(v_max), max_lat_acc(max_lat_acc)
+{
+}
+
+void VelocityProfile::reserve(size_t n)
+{
+    seg.reserve(n);
+    v_lat.reserve(n);
+    v_fwd.reserve(n);
+    v.reserve(n);
+}
+
+// velocity limit of point i from the curvature through its neighbours, v_max at the ends of the path
+float VelocityProfile::curvatureLimit(const std::vector<PathPoint> &path, size_t i) const
+{
+    if (i == 0 || i + 1 >= path.size())
+        return v_max;
+    const PathPoint &a = path[i-1], &b = path[i], &c = path[i+1];
+    float k = std::fabs(geometry::curvature(a.x, a.y, b.x, b.y, c.x, c.y));
+    if (k * v_max * v_max <= max_lat_acc)
+        return v_max;
+    return std::sqrt(max_lat_acc / k);
+}
+
+size_t VelocityProfile::update(std::vector<PathPoint> &path, size_t from)
+{
+    size_t n = path.size();
+    if (from >= n && n == v.size())
+        return n;       // nothing changed
+    from = std::min(from, std::min(n, v.size()));
+    seg.resize(n);
+    v_lat.resize(n);
+    v_fwd.resize(n);
+    v.resize(n);
+    if (n == 0)
+        return 0;
+
+    size_t start = (from > 0) ? from - 1 : 0;
+    for (size_t i = from; i < n; i++)
+        seg[i] = (i > 0) ? geometry::dist(path[i-1], path[i]) : 0;
+    for (size_t i = start; i < n; i++)
+    {
+        v_lat[i] = curvatureLimit(path, i);
+        if (i == 0)
+            v_fwd[i] = 0;
+        else
+            v_fwd[i] = std::min(v_lat[i], std::sqrt(v_fwd[i-1] * v_fwd[i-1] + 2 * (float)MAX_ACC * seg[i]));
+    }
+
+    size_t changed = n - 1;
+    v[n-1] = 0;
+    for (size_t i = n - 1; i-- > 0;)
+    {
+        float vi = std::min(v_fwd[i], std::sqrt(v[i+1] * v[i+1] - 2 * (float)MAX_DECEL * seg[i+1]));
+        if (i < start && vi == v[i])
+            break;
+        v[i] = vi;
+        changed = i;
+    }
+    for (size_t i = changed; i < n; i++)
+        path[i].velocity = v[i];
+    return changed;
+}
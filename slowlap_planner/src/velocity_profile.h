@@ -0,0 +1,40 @@
+/**
+ * This is the velocity profile of the path
+ * the reference velocity of every path point is the lowest of
+ * - the curvature limit: sqrt(max lateral acceleration * radius), radius of the circle through the point and its neighbours
+ * - the forward pass: the car can only speed up by MAX_ACC from the first point (car at rest)
+ * - the backward pass: the car must be able to stop (MAX_DECEL) at the last point, the end of the known path
+ * the path only changes at its end (search horizon popped and searched again), so update() only recomputes
+ * the points from the first changed one, plus the points before it that the backward pass slows down
+**/
+
+#ifndef SRC_VELOCITY_PROFILE_H
+#define SRC_VELOCITY_PROFILE_H
+
+#include <vector>
+#include <cstddef>
+#include "cone.h"
+#include <slowlap_common/vehicle_limits.h>  // MAX_ACC, MAX_DECEL
+
+class VelocityProfile
+{
+public:
+    VelocityProfile(float v_max, float max_lat_acc);
+    void reserve(size_t);
+
+    // sets path[i].velocity, the points before from must be the same as in the last call
+    // returns the first point whose velocity was set
+    size_t update(std::vector<PathPoint> &path, size_t from);
+
+private:
+    float v_max;                // velocity limit on straights (m/s)
+    float max_lat_acc;          // lateral acceleration limit (m/s^2)
+    std::vector<float> seg;     // distance from the point before, 0 for the first point
+    std::vector<float> v_lat;   // curvature limit
+    std::vector<float> v_fwd;   // after the forward pass
+    std::vector<float> v;       // after the backward pass, the reference velocity
+
+    float curvatureLimit(const std::vector<PathPoint>&, size_t) const;
+};
+
+#endif // SRC_VELOCITY_PROFILE_H
@@ -0,0 +1,109 @@
+/**
+ * checks the SIMD cost kernel (edgeCosts) against the scalar one (edgeCostsScalar)
+ * the SIMD versions use a polynomial atan2, so near the feasibility limits (max_angle, width and step)
+ * the two may decide differently, those edges are only checked inside a tolerance band
+ **/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include "edge_cost.h"
+
+#define ANGLE_TOL 2e-3f         // max angle difference (degrees), the polynomial is within 0.001
+#define LENGTH_TOL 1e-4f        // relative band around the width and step limits
+
+static const EdgeCostParams params = {4, 2, 6, 0.5, 8, 50};     // as PathPlanner (TRACKWIDTH 4)
+
+// edge i close to a feasibility limit, where rounding may flip the decision
+static bool nearLimit(const EdgeBatch &b, size_t i, float x, float y, float angle)
+{
+    float w = std::hypot(b.rx[i] - b.lx[i], b.ry[i] - b.ly[i]);
+    float s = std::hypot((b.lx[i] + b.rx[i]) / 2 - x, (b.ly[i] + b.ry[i]) / 2 - y);
+    auto near = [](float v, float limit) { return std::fabs(v - limit) <= LENGTH_TOL * limit; };
+    return std::fabs(std::fabs(angle) - params.max_angle) <= ANGLE_TOL ||
+           near(w, params.min_width) || near(w, params.max_width) || near(s, params.min_step) || near(s, params.max_step);
+}
+
+// random edges around (x, y), sized so most are feasible and the rest fail one limit or another
+static void randomBatch(EdgeBatch &b, size_t n, float x, float y, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> pos(-10, 10), offset(-4, 4);
+    b.clear();
+    for (size_t i = 0; i < n; i++)
+    {
+        PathPoint mid(x + pos(rng), y + pos(rng));
+        PathPoint l(mid.x + offset(rng), mid.y + offset(rng));
+        PathPoint r(2 * mid.x - l.x, 2 * mid.y - l.y);
+        b.push(i, l, i, r);
+    }
+}
+
+// the same edges, one at a time and batched
+static void compare(EdgeBatch &b, float x, float y, float hx, float hy)
+{
+    EdgeBatch ref = b;
+    edgeCostsScalar(ref, x, y, hx, hy, params);
+    edgeCosts(b, x, y, hx, hy, params);
+    ASSERT_EQ(b.cost.size(), b.size());
+    ASSERT_EQ(b.angle.size(), b.size());
+    for (size_t i = 0; i < b.size(); i++)
+    {
+        EXPECT_NEAR(b.angle[i], ref.angle[i], ANGLE_TOL) << "edge " << i << " of " << b.size();
+        bool feasible = std::isfinite(b.cost[i]), ref_feasible = std::isfinite(ref.cost[i]);
+        if (feasible != ref_feasible)
+        {
+            EXPECT_TRUE(nearLimit(ref, i, x, y, ref.angle[i])) << "edge " << i << " of " << b.size();
+            continue;
+        }
+        if (feasible)
+            EXPECT_NEAR(b.cost[i], ref.cost[i], 1e-4f) << "edge " << i << " of " << b.size();
+    }
+}
+
+// sizes that are not multiples of the lane count, so the scalar tail is covered too
+TEST(EdgeCost, RandomBatchesMatchScalar)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(-50, 50), dir(-1, 1);
+    for (size_t n: {0, 1, 3, 5, 7, 8, 9, 13, 17, 31, 100, 1001})
+    {
+        for (int k = 0; k < 20; k++)
+        {
+            float x = coord(rng), y = coord(rng);
+            float hx = dir(rng), hy = dir(rng);
+            if (hx == 0 && hy == 0)
+                hx = 1;
+            EdgeBatch b;
+            randomBatch(b, n, x, y, rng);
+            compare(b, x, y, hx, hy);
+        }
+    }
+}
+
+// edges right on the limits: the decisions may differ, but only inside the tolerance band
+TEST(EdgeCost, LimitsMatchScalar)
+{
+    const float x = 3, y = -2;
+    EdgeBatch b;
+    for (float a: {-50.0f, -49.999f, 49.999f, 50.0f, 50.001f, 0.0f, 180.0f})
+    {
+        for (float s: {0.5f, 0.50001f, 8.0f, 7.9999f, 4.0f})
+        {
+            for (float w: {2.0f, 2.0001f, 6.0f, 5.9999f, 4.0f})
+            {
+                float rad = a * (float)M_PI / 180;
+                PathPoint mid(x + s * std::cos(rad), y + s * std::sin(rad));
+                // the edge is across the step direction, like a pair of cones ahead
+                float nx = -std::sin(rad) * w / 2, ny = std::cos(rad) * w / 2;
+                b.push(0, PathPoint(mid.x + nx, mid.y + ny), 0, PathPoint(mid.x - nx, mid.y - ny));
+            }
+        }
+    }
+    compare(b, x, y, 1, 0);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
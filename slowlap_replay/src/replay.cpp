@@ -0,0 +1,184 @@
+/**
+ * This is the offline replay tool for the slow lap planner and follower
+ * cone and odometry msgs recorded from SLAM are read from bag files in time order (rosbag C++ API, no roscore)
+ * and passed straight to PathPlanner::update and the follower, as fast as the CPU allows
+ * at the end the latency distribution of each stage and the total throughput are printed
+ *
+ * usage: rosrun slowlap_replay slowlap_replay <file.bag> [<file.bag> ...] [--verbose]
+ * --verbose keeps the planner/follower debug messages (only warnings and errors are logged by default)
+**/
+
+#include "replay.h"
+#include "path_planner.h"
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <nav_msgs/Odometry.h>
+#include "mur_common/cone_msg.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+double LatencyStats::total() const
+{
+    return std::accumulate(samples.begin(), samples.end(), 0.0);
+}
+
+void LatencyStats::report()
+{
+    std::cout << std::left << std::setw(22) << name << std::right;
+    if (samples.empty())
+    {
+        std::cout << "no calls" << std::endl;
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto pct = [this](double p) { return samples[(size_t)(p * (samples.size() - 1))]; };
+    std::cout << std::fixed << std::setprecision(1)
+              << "n=" << std::setw(7) << samples.size()
+              << " mean=" << std::setw(8) << total() / samples.size()
+              << " p50=" << std::setw(8) << pct(0.5)
+              << " p90=" << std::setw(8) << pct(0.9)
+              << " p99=" << std::setw(8) << pct(0.99)
+              << " max=" << std::setw(8) << samples.back() << " us" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> bag_files;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--verbose")
+            verbose = true;
+        else
+            bag_files.push_back(arg);
+    }
+    if (bag_files.empty())
+    {
+        std::cerr << "usage: slowlap_replay <file.bag> [<file.bag> ...] [--verbose]" << std::endl;
+        return 1;
+    }
+
+    PlannerConfig config;               // same defaults as the planner node
+    ConeIngest ingest;
+    PlannerInput input;
+    PlannerOutput result;
+    std::unique_ptr<PathPlanner> planner;
+    FollowerReplay follower;
+    PathStreamWriter path_stream;       // same msgs as between the planner and follower nodes
+    PathDelta path_delta;
+
+    LatencyStats ingest_stats("cone ingest");
+    LatencyStats planner_stats("planner update");
+    LatencyStats spline_stats("follower path/spline");
+    LatencyStats control_stats("follower control");
+
+    double car_x = 0, car_y = 0;
+    bool odom_received = false;
+    bool complete = false;
+    size_t cone_msgs = 0, odom_msgs = 0;
+    double bag_duration = 0;
+
+    if (!verbose)
+        slowlap_log::setLevel(LOG_LEVEL_WARN);
+
+    ClockTP replay_start = Clock::now();
+    for (auto &file: bag_files)
+    {
+        rosbag::Bag bag;
+        try
+        {
+            bag.open(file, rosbag::bagmode::Read);
+        }
+        catch (const rosbag::BagException &e)
+        {
+            std::cerr << "[REPLAY] could not open " << file << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        std::vector<std::string> topics = {CONE_TOPIC, ODOM_TOPIC};
+        rosbag::View view(bag, rosbag::TopicQuery(topics));
+        bag_duration += (view.getEndTime() - view.getBeginTime()).toSec();
+
+        for (const rosbag::MessageInstance &m: view)
+        {
+            if (m.getTopic() == ODOM_TOPIC)
+            {
+                nav_msgs::Odometry::ConstPtr odom = m.instantiate<nav_msgs::Odometry>();
+                if (!odom)
+                    continue;
+                odom_msgs++;
+                car_x = odom->pose.pose.position.x;
+                car_y = odom->pose.pose.position.y;
+                const auto &q = odom->pose.pose.orientation;
+                double yaw = std::atan2(2 * (q.w * q.z + q.x * q.y), 1 - 2 * (q.y * q.y + q.z * q.z));
+
+                ClockTP start = Clock::now();
+                follower.updatePose(car_x, car_y, yaw, odom->twist.twist.linear.x);
+                follower.control();
+                control_stats.add(start, Clock::now());
+                odom_received = true;
+            }
+            else
+            {
+                mur_common::cone_msg::ConstPtr cones = m.instantiate<mur_common::cone_msg>();
+                if (!cones || cones->x.empty())
+                    continue;
+                cone_msgs++;
+
+                ClockTP start = Clock::now();
+                ingest.decode(cones->x, cones->y, cones->colour);
+                if (!planner) // initialise like the planner node, once the car position and orange cones are known
+                {
+                    if (!odom_received)
+                        continue;
+                    ingest.takeSnapshot(input.cones.added);
+                    int countRed = std::count_if(input.cones.added.begin(), input.cones.added.end(),
+                                                 [](const Cone &cn) { return cn.colour == 'r'; });
+                    if (countRed > 1)
+                    {
+                        input.car_x = car_x;
+                        input.car_y = car_y;
+                        planner = std::unique_ptr<PathPlanner>(new PathPlanner(config, input));
+                    }
+                    continue;
+                }
+                ingest.diff(input.cones);
+                ClockTP ingested = Clock::now();
+                ingest_stats.add(start, ingested);
+
+                input.car_x = car_x;
+                input.car_y = car_y;
+                planner->update(input, result);
+                ClockTP planned = Clock::now();
+                planner_stats.add(ingested, planned);
+                complete = result.complete;
+
+                if (path_stream.update(result.path, path_delta))
+                    follower.updatePath(path_delta);
+                spline_stats.add(planned, Clock::now());
+            }
+        }
+        bag.close();
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - replay_start).count();
+
+    std::cout << "[REPLAY] " << bag_files.size() << " bag(s), " << cone_msgs << " cone msgs, "
+              << odom_msgs << " odom msgs, track " << (complete ? "complete" : "not complete") << std::endl;
+    ingest_stats.report();
+    planner_stats.report();
+    spline_stats.report();
+    control_stats.report();
+
+    double busy = (ingest_stats.total() + planner_stats.total() + spline_stats.total() + control_stats.total()) * 1e-6;
+    std::cout << std::fixed << std::setprecision(3)
+              << "[REPLAY] wall time " << wall << " s (" << busy << " s in planner/follower), bag time "
+              << bag_duration << " s" << std::endl
+              << std::setprecision(0)
+              << "[REPLAY] throughput " << (cone_msgs + odom_msgs) / wall << " msgs/s, "
+              << planner_stats.samples.size() / wall << " planner updates/s" << std::endl;
+    return 0;
+}
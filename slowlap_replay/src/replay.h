@@ -0,0 +1,57 @@
+/**
+ * This is the replay tool header file
+ * recorded cone and odometry msgs are read from bag files and passed straight to the planner
+ * and follower cores (no roscore, no ros::Rate), each call is timed
+*/
+
+#ifndef SRC_REPLAY_H
+#define SRC_REPLAY_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <slowlap_common/path_stream.h>     // planner -> follower path msgs
+
+#define CONE_TOPIC "/mur/slam/cones"
+#define ODOM_TOPIC "/mur/slam/Odom"
+
+typedef std::chrono::steady_clock Clock;
+typedef std::chrono::steady_clock::time_point ClockTP;
+
+// latency samples of one stage, reported as a distribution at the end of the replay
+struct LatencyStats
+{
+    explicit LatencyStats(const std::string &name) : name(name) {}
+    std::string name;
+    std::vector<double> samples;    // microseconds
+
+    void add(const ClockTP &start, const ClockTP &end)
+    {
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    double total() const;           // sum of all samples, microseconds
+    void report();                  // print count, mean, p50/p90/p99, max
+};
+
+class FollowerCore;
+
+// follower side of the replay, kept in its own file since planner and follower headers
+// both define DEBUG and some of the same constants
+class FollowerReplay
+{
+public:
+    FollowerReplay();
+    ~FollowerReplay();
+    void updatePose(double, double, double, double);        // car x, y, yaw, v
+    bool updatePath(const PathDelta&);  // applies a path stream msg, re-splines if the path changed
+    void control();                 // goal point search and pure pursuit
+    double acceleration() const;
+    double steering() const;
+
+private:
+    std::unique_ptr<FollowerCore> core;
+    bool path_received = false;     // control needs a path first
+};
+
+#endif // SRC_REPLAY_H
@@ -0,0 +1,41 @@
+/**
+ * follower side of the replay, see replay.h
+**/
+
+#include "replay.h"
+#include "follower_core.h"
+
+FollowerReplay::FollowerReplay()
+    : core(new FollowerCore()) {}
+
+FollowerReplay::~FollowerReplay() {}
+
+void FollowerReplay::updatePose(double x, double y, double yaw, double v)
+{
+    core->updatePose(x, y, yaw, v);
+}
+
+bool FollowerReplay::updatePath(const PathDelta &delta)
+{
+    bool changed = core->updatePath(delta);
+    path_received = path_received || changed;
+    return changed;
+}
+
+void FollowerReplay::control()
+{
+    if (!path_received)
+        return;
+    core->DrivingControl();
+    core->clearVars();
+}
+
+double FollowerReplay::acceleration() const
+{
+    return core->acceleration;
+}
+
+double FollowerReplay::steering() const
+{
+    return core->steering;
+}